@@ -0,0 +1,177 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "function.h"
+#include "thread_pool.h"
+#include "util.h"
+
+// Baseline: the classic executor, one std::deque behind one mutex.
+class SharedQueuePool {
+public:
+    explicit SharedQueuePool(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~SharedQueuePool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_cv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    template <typename F>
+    void post(F&& func) {
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.emplace_back(std::forward<F>(func));
+            ++unfinished_;
+        }
+        wake_cv_.notify_one();
+    }
+
+    void wait_idle() {
+        std::unique_lock lock(mutex_);
+        idle_cv_.wait(lock, [this] { return unfinished_ == 0; });
+    }
+
+private:
+    void worker_loop() {
+        while (true) {
+            MoveOnlyFunction<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                wake_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+            std::lock_guard lock(mutex_);
+            if (--unfinished_ == 0) {
+                idle_cv_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::deque<MoveOnlyFunction<void()>> tasks_;
+    size_t unfinished_ = 0;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable idle_cv_;
+};
+
+// a few hundred nanoseconds of work per task
+inline uint64_t tiny_work(uint64_t seed) {
+    for (int i = 0; i < 64; ++i) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    return seed;
+}
+
+constexpr int64_t kLeaf = 16;
+
+template <typename Pool>
+void split(Pool& pool, std::atomic<uint64_t>& sink, int64_t from, int64_t to) {
+    if (to - from <= kLeaf) {
+        uint64_t local = 0;
+        for (int64_t i = from; i < to; ++i) {
+            local ^= tiny_work(i);
+        }
+        sink.fetch_xor(local, std::memory_order_relaxed);
+        return;
+    }
+    int64_t mid = from + (to - from) / 2;
+    pool.post([&pool, &sink, from, mid] { split(pool, sink, from, mid); });
+    pool.post([&pool, &sink, mid, to] { split(pool, sink, mid, to); });
+}
+
+template <typename Pool>
+double run_flat(Pool& pool, int64_t tasks) {
+    std::atomic<uint64_t> sink = 0;
+    Timer timer;
+    for (int64_t i = 0; i < tasks; ++i) {
+        pool.post([&sink, i] { sink.fetch_xor(tiny_work(i), std::memory_order_relaxed); });
+    }
+    pool.wait_idle();
+    return std::chrono::duration<double, std::milli>(timer.GetTimes().wall_time).count();
+}
+
+template <typename Pool>
+double run_nested(Pool& pool, int64_t items) {
+    std::atomic<uint64_t> sink = 0;
+    Timer timer;
+    pool.post([&pool, &sink, items] { split(pool, sink, 0, items); });
+    pool.wait_idle();
+    return std::chrono::duration<double, std::milli>(timer.GetTimes().wall_time).count();
+}
+
+template <typename Body>
+double measure(Body&& body) {
+    Timer timer;
+    body();
+    return std::chrono::duration<double, std::milli>(timer.GetTimes().wall_time).count();
+}
+
+void bench_hot_loop() {
+    constexpr size_t kCalls = 200'000'000;
+    uint64_t acc = 0;
+    auto step = [&acc](uint64_t x) { acc = acc * 31 + x; };
+    Function<void(uint64_t)> func = step;
+
+    double plain = measure([&] {
+        for (size_t i = 0; i < kCalls; ++i) {
+            func(i);
+        }
+    });
+    double batched = measure([&] { func.invoke_n(kCalls, 7); });
+    double typed = measure([&] { func.invoke_n<decltype(step)>(kCalls, 7); });
+
+    std::cout << "hot loop, " << kCalls << " calls (ms): operator() " << plain << ", invoke_n "
+              << batched << ", invoke_n<F> " << typed << " (acc " << acc << ")\n\n";
+}
+
+int main() {
+    bench_hot_loop();
+
+    constexpr int64_t kFlatTasks = 1'000'000;
+    constexpr int64_t kNestedItems = 1 << 22;
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "threads\tflat shared\tflat stealing\tnested shared\tnested stealing (ms)\n";
+    for (size_t threads = 1; threads <= hardware; threads *= 2) {
+        double flat_shared;
+        double nested_shared;
+        {
+            SharedQueuePool pool(threads);
+            flat_shared = run_flat(pool, kFlatTasks);
+            nested_shared = run_nested(pool, kNestedItems);
+        }
+        double flat_stealing;
+        double nested_stealing;
+        {
+            ThreadPool pool(threads);
+            flat_stealing = run_flat(pool, kFlatTasks);
+            nested_stealing = run_nested(pool, kNestedItems);
+        }
+        std::cout << threads << '\t' << flat_shared << '\t' << flat_stealing << '\t'
+                  << nested_shared << '\t' << nested_stealing << '\n';
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque (in the C11 formulation by Le, Pop, Cohen
+// and Zappa Nardelli). The owner pushes and pops at the bottom, thieves
+// take from the top. T has to be trivially copyable, in practice a pointer:
+// the slots are plain atomics, so a thief that loses the race just drops
+// its copy.
+template <typename T>
+class WorkStealingDeque {
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    struct ring {
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit ring(size_t capacity)
+            : mask(capacity - 1),
+              slots(std::make_unique<std::atomic<T>[]>(capacity)) {
+        }
+
+        size_t capacity() const {
+            return mask + 1;
+        }
+
+        T get(int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T value) {
+            slots[static_cast<size_t>(index) & mask].store(value, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(kCacheLine) std::atomic<int64_t> top_{0};
+    alignas(kCacheLine) std::atomic<int64_t> bottom_{0};
+    std::atomic<ring*> buffer_;
+
+    // a thief may still read from a ring after the owner grew the deque,
+    // so old rings are kept until the deque dies
+    std::vector<std::unique_ptr<ring>> rings_;
+
+    ring* grow(ring* old, int64_t bottom, int64_t top) {
+        auto bigger = std::make_unique<ring>(old->capacity() * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        ring* result = bigger.get();
+        rings_.push_back(std::move(bigger));
+        buffer_.store(result, std::memory_order_release);
+        return result;
+    }
+
+public:
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    explicit WorkStealingDeque(size_t capacity = 256) {
+        rings_.push_back(std::make_unique<ring>(capacity));
+        buffer_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // owner only
+    void push(T value) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        ring* buffer = buffer_.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(buffer->capacity()) - 1) {
+            buffer = grow(buffer, bottom, top);
+        }
+        buffer->put(bottom, value);
+        // publishes the slot (and whatever it points to) to thieves
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // owner only, LIFO end
+    bool pop(T& out) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        ring* buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = buffer->get(bottom);
+        if (top == bottom) {
+            // the last element, race with thieves for it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // any thread, FIFO end
+    bool steal(T& out) {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return false;
+        }
+        ring* buffer = buffer_.load(std::memory_order_acquire);
+        T value = buffer->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+};
@@ -1,11 +1,19 @@
-#include <algorithm>  // std::swap_ranges
+#pragma once
+
+#include <algorithm>  // std::copy
+#include <atomic>
 #include <functional>
 #include <iostream>
-template <typename, bool Copyable>
+#include <memory>
+#include <typeinfo>
+#include <utility>
+
+// SharedStorage: big targets live in one refcounted block, copies share it
+template <typename, bool Copyable, bool SharedStorage = false>
 class GenericFunction;
 
-template <typename Ret, typename... Args, bool Copyable>
-class GenericFunction<Ret(Args...), Copyable> {
+template <typename Ret, typename... Args, bool Copyable, bool SharedStorage>
+class GenericFunction<Ret(Args...), Copyable, SharedStorage> {
 private:
     static const size_t kBufferSize = 16;
 
@@ -16,33 +24,79 @@ private:
     using invoke_ptr_t = Ret (*)(void*, Args...);
     using destroy_ptr_t = void (*)(void*);
     using copy_ptr_t = void* (*)(void*, char*);
+    // gets &fptr_, writes the address of the stored callable, returns its type
+    using inspect_ptr_t = const std::type_info& (*)(void* const*, void**);
 
     struct custom_vtable {
         invoke_ptr_t invoke_ptr;
         destroy_ptr_t destroy_ptr;
         copy_ptr_t copy_ptr;
+        inspect_ptr_t inspect_ptr;
 
         custom_vtable()
             : invoke_ptr(nullptr),
               destroy_ptr(nullptr),
-              copy_ptr(nullptr) {
+              copy_ptr(nullptr),
+              inspect_ptr(nullptr) {
         }
 
-        custom_vtable(invoke_ptr_t invoke_ptr, destroy_ptr_t destroy_ptr, copy_ptr_t copy_ptr)
+        custom_vtable(invoke_ptr_t invoke_ptr, destroy_ptr_t destroy_ptr, copy_ptr_t copy_ptr,
+                      inspect_ptr_t inspect_ptr = nullptr)
             : invoke_ptr(invoke_ptr),
               destroy_ptr(destroy_ptr),
-              copy_ptr(copy_ptr) {
+              copy_ptr(copy_ptr),
+              inspect_ptr(inspect_ptr) {
         }
 
         void clear() {
             invoke_ptr = nullptr;
             destroy_ptr = nullptr;
             copy_ptr = nullptr;
+            inspect_ptr = nullptr;
         }
     };
 
     custom_vtable vt_;
 
+    struct no_refs {};
+
+    // storage for targets that don't fit into small_buffer_,
+    // remembers the allocator it came from to give the memory back
+    template <typename F, typename Alloc>
+    struct heap_block {
+        [[no_unique_address]] std::conditional_t<SharedStorage, std::atomic<size_t>, no_refs> refs;
+        [[no_unique_address]] Alloc alloc;
+        F value;
+
+        template <typename U>
+        heap_block(const Alloc& allocator, U&& func)
+            : refs(),
+              alloc(allocator),
+              value(std::forward<U>(func)) {
+            if constexpr (SharedStorage) {
+                refs.store(1, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    template <typename F, typename Alloc>
+    using block_alloc_t =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<heap_block<F, Alloc>>;
+
+    template <typename F, typename Alloc>
+    using block_traits = std::allocator_traits<block_alloc_t<F, Alloc>>;
+
+    // shared targets may be called from several owners at once,
+    // so they are invoked only through const&
+    template <typename F>
+    using stored_t = std::conditional_t<SharedStorage, const F, F>;
+
+    template <typename F>
+    static constexpr bool kIsStorable =
+        !std::is_same_v<std::remove_cvref_t<F>, GenericFunction> &&
+        !std::is_function_v<std::remove_cvref_t<F>> && std::invocable<F, Args...> &&
+        (!SharedStorage || std::invocable<const std::remove_cvref_t<F>&, Args...>);
+
 private:
     template <typename F>
     static Ret invoker(void* func, Args... args) {
@@ -51,27 +105,74 @@ private:
 
     template <typename F>
     static void destroyer(void* func) {
-        if constexpr (sizeof(F) > kBufferSize) {
-            delete reinterpret_cast<F*>(func);
-        } else {
-            reinterpret_cast<F*>(func)->~F();
-        }
+        reinterpret_cast<F*>(func)->~F();
     }
 
-    template <typename F, bool TreatAsObject>
+    template <typename F>
     static void* copier(void* func, char* target_buffer)
         requires Copyable
     {
+        new (target_buffer) F(*reinterpret_cast<F*>(func));
+        return target_buffer;
+    }
+
+    template <typename F>
+    static const std::type_info& inspector(void* const* slot, void** address) {
+        *address = *slot;
+        return typeid(F);
+    }
 
-        if constexpr (TreatAsObject) {
-            if constexpr (sizeof(F) > kBufferSize) {
-                return new F(*reinterpret_cast<F*>(func));
-            } else {
-                new (target_buffer) F(*reinterpret_cast<F*>(func));
-                return target_buffer;
+    template <typename F, typename Alloc>
+    static const std::type_info& block_inspector(void* const* slot, void** address) {
+        *address = &static_cast<heap_block<F, Alloc>*>(*slot)->value;
+        return typeid(F);
+    }
+
+    template <typename F, typename Alloc, typename U>
+    static heap_block<F, Alloc>* make_block(const Alloc& alloc, U&& func) {
+        block_alloc_t<F, Alloc> block_alloc(alloc);
+        heap_block<F, Alloc>* block = block_traits<F, Alloc>::allocate(block_alloc, 1);
+        try {
+            block_traits<F, Alloc>::construct(block_alloc, block, alloc, std::forward<U>(func));
+        } catch (...) {
+            block_traits<F, Alloc>::deallocate(block_alloc, block, 1);
+            throw;
+        }
+        return block;
+    }
+
+    template <typename F, typename Alloc>
+    static Ret block_invoker(void* block, Args... args) {
+        stored_t<F>& func = static_cast<heap_block<F, Alloc>*>(block)->value;
+        return std::invoke(func, std::forward<Args>(args)...);
+    }
+
+    template <typename F, typename Alloc>
+    static void block_destroyer(void* block) {
+        auto* typed = static_cast<heap_block<F, Alloc>*>(block);
+        if constexpr (SharedStorage) {
+            if (typed->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
             }
+        }
+        block_alloc_t<F, Alloc> block_alloc(typed->alloc);
+        block_traits<F, Alloc>::destroy(block_alloc, typed);
+        block_traits<F, Alloc>::deallocate(block_alloc, typed, 1);
+    }
+
+    template <typename F, typename Alloc>
+    static void* block_copier(void* block, char*)
+        requires Copyable
+    {
+        auto* typed = static_cast<heap_block<F, Alloc>*>(block);
+        if constexpr (SharedStorage) {
+            // O(1) copy: one more owner of the same block
+            typed->refs.fetch_add(1, std::memory_order_relaxed);
+            return block;
         } else {
-            return func;
+            return make_block<F>(
+                std::allocator_traits<Alloc>::select_on_container_copy_construction(typed->alloc),
+                std::as_const(typed->value));
         }
     }
 
@@ -87,6 +188,18 @@ private:
         return fptr_ == small_buffer_;
     }
 
+    template <typename T>
+    stored_t<T>* target_address() const {
+        if (!vt_.inspect_ptr) {
+            return nullptr;
+        }
+        void* address = nullptr;
+        if (vt_.inspect_ptr(&fptr_, &address) != typeid(T)) {
+            return nullptr;
+        }
+        return static_cast<stored_t<T>*>(address);
+    }
+
 public:
     // empty constructor
     GenericFunction()
@@ -97,33 +210,49 @@ public:
     // i can't call sizeof from c-style func
     // so i write requires
     template <typename F>
-        requires(!std::is_same_v<std::remove_cvref_t<F>, GenericFunction> &&
-                 !std::is_function_v<std::remove_cvref_t<F>> && std::invocable<F, Args...>)
+        requires kIsStorable<F>
     GenericFunction(F&& func)
-        : vt_(reinterpret_cast<invoke_ptr_t>(&invoker<std::remove_cvref_t<F>>),
-              reinterpret_cast<destroy_ptr_t>(&destroyer<std::remove_cvref_t<F>>), nullptr) {
-        if constexpr (Copyable) {
-            vt_.copy_ptr = reinterpret_cast<copy_ptr_t>(&copier<std::remove_cvref_t<F>, true>);
-        }
+        : GenericFunction(std::allocator_arg, std::allocator<std::remove_cvref_t<F>>(),
+                          std::forward<F>(func)) {
+    }
+
+    // big targets go to memory taken from alloc (arena, pool, StackAllocator...),
+    // small ones still live in small_buffer_ and alloc is not touched
+    template <typename Alloc, typename F>
+        requires kIsStorable<F>
+    GenericFunction(std::allocator_arg_t, const Alloc& alloc, F&& func)
+        : fptr_(nullptr) {
         using TrueType = std::remove_cvref_t<F>;
         if constexpr (sizeof(TrueType) > kBufferSize) {
-            fptr_ = new F(std::forward<F>(func));
+            vt_ = custom_vtable(&block_invoker<TrueType, Alloc>, &block_destroyer<TrueType, Alloc>,
+                                nullptr, &block_inspector<TrueType, Alloc>);
+            if constexpr (Copyable) {
+                vt_.copy_ptr = &block_copier<TrueType, Alloc>;
+            }
+            fptr_ = make_block<TrueType>(alloc, std::forward<F>(func));
         } else {
+            vt_ = custom_vtable(&invoker<stored_t<TrueType>>, &destroyer<TrueType>, nullptr,
+                                &inspector<TrueType>);
+            if constexpr (Copyable) {
+                vt_.copy_ptr = &copier<TrueType>;
+            }
             new (small_buffer_) TrueType(std::forward<F>(func));
             fptr_ = small_buffer_;
         }
     }
 
-    // this is for functions
+    // this is for functions: the pointer is a small target like any other,
+    // an F* object in small_buffer_
     template <typename F>
         requires(std::is_function_v<std::remove_cvref_t<F>> && std::invocable<F, Args...>)
     GenericFunction(F* func)
-        : fptr_(reinterpret_cast<void*>(func)),
-          vt_(reinterpret_cast<invoke_ptr_t>(&invoker<std::remove_cvref_t<F>>),
+        : fptr_(small_buffer_),
+          vt_(&invoker<F*>,
               nullptr,  // nothing to destroy
-              nullptr) {
+              nullptr, &inspector<F*>) {
+        new (small_buffer_) F*(func);
         if constexpr (Copyable) {
-            vt_.copy_ptr = reinterpret_cast<copy_ptr_t>(&copier<std::remove_cvref_t<F>, false>);
+            vt_.copy_ptr = &copier<F*>;
         }
     }
 
@@ -161,10 +290,10 @@ public:
 
         std::swap(vt_, f.vt_);
 
-        // then need to do something with buffer
-        std::swap_ranges(small_buffer_, small_buffer_ + kBufferSize, f.small_buffer_);
-
+        // the buffer is only read when the target lives there: an empty or a
+        // heap-stored f has never written it
         if (f.is_small()) {
+            std::copy(f.small_buffer_, f.small_buffer_ + kBufferSize, small_buffer_);
             fptr_ = small_buffer_;
         } else {
             std::swap(fptr_, f.fptr_);
@@ -189,6 +318,68 @@ public:
         return vt_.invoke_ptr(fptr_, std::forward<Args>(args)...);
     }
 
+    // calls the target n times with the same arguments; with F given and
+    // matching the stored type the loop calls F directly, so it can be inlined
+    template <typename F = void>
+        requires(!std::is_rvalue_reference_v<Args> && ...)
+    void invoke_n(size_t n, Args... args) const {
+        if constexpr (!std::is_void_v<F>) {
+            if (auto* func = target_address<F>()) {
+                for (size_t i = 0; i < n; ++i) {
+                    std::invoke(*func, args...);
+                }
+                return;
+            }
+        }
+        if (!vt_.invoke_ptr) {
+            throw std::bad_function_call();
+        }
+        invoke_ptr_t call = vt_.invoke_ptr;
+        for (size_t i = 0; i < n; ++i) {
+            call(fptr_, args...);
+        }
+    }
+
+    // calls the target for every element of [first, last), same rules as invoke_n
+    template <typename F = void, typename InputIt>
+        requires(sizeof...(Args) == 1)
+    void for_each(InputIt first, InputIt last) const {
+        if constexpr (!std::is_void_v<F>) {
+            if (auto* func = target_address<F>()) {
+                for (; first != last; ++first) {
+                    std::invoke(*func, *first);
+                }
+                return;
+            }
+        }
+        if (!vt_.invoke_ptr) {
+            throw std::bad_function_call();
+        }
+        invoke_ptr_t call = vt_.invoke_ptr;
+        for (; first != last; ++first) {
+            call(fptr_, *first);
+        }
+    }
+
+    // nullptr if empty or if the target is not a T
+    template <typename T>
+    stored_t<T>* target() {
+        return target_address<T>();
+    }
+
+    template <typename T>
+    const T* target() const {
+        return target_address<T>();
+    }
+
+    const std::type_info& target_type() const {
+        if (!vt_.inspect_ptr) {
+            return typeid(void);
+        }
+        void* address = nullptr;
+        return vt_.inspect_ptr(&fptr_, &address);
+    }
+
     ~GenericFunction() {
         destroy_helper();
     }
@@ -208,6 +399,12 @@ struct MoveOnlyFunction : GenericFunction<Stuff, false> {
     using GenericFunction<Stuff, false>::GenericFunction;
 };
 
+// Function for fan-out: copies of a big target share one immutable instance
+template <typename Stuff>
+struct SharedFunction : GenericFunction<Stuff, true, true> {
+    using GenericFunction<Stuff, true, true>::GenericFunction;
+};
+
 // standard functions
 template <typename R, typename... Args>
 Function(R (*)(Args...)) -> Function<R(Args...)>;
@@ -240,3 +437,10 @@ struct move_only_function_traits<R (C::*)(Args...) const> {
 template <typename F>
 MoveOnlyFunction(F)
     -> MoveOnlyFunction<typename move_only_function_traits<decltype(&F::operator())>::signature>;
+
+// standard functions
+template <typename R, typename... Args>
+SharedFunction(R (*)(Args...)) -> SharedFunction<R(Args...)>;
+
+template <typename F>
+SharedFunction(F) -> SharedFunction<typename function_traits<decltype(&F::operator())>::signature>;
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "function.h"
+
+// Bounded lock-free multi-producer multi-consumer ring buffer
+// (D. Vyukov's scheme: every cell has its own sequence number).
+// Values are stored inline in the cells, so for a MoveOnlyFunction
+// with a small target neither push nor pop touches the heap.
+template <typename T>
+class MpmcQueue {
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    struct alignas(kCacheLine) cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    size_t mask_;
+    std::unique_ptr<cell[]> cells_;
+
+    // producers and consumers hammer different counters, keep them apart
+    alignas(kCacheLine) std::atomic<size_t> enqueue_pos_{0};
+    alignas(kCacheLine) std::atomic<size_t> dequeue_pos_{0};
+
+    // runs before cells_ is allocated, so a bad capacity costs no allocation
+    static size_t checked_capacity(size_t capacity) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("MpmcQueue capacity must be a power of two");
+        }
+        return capacity;
+    }
+
+public:
+    // capacity has to be a power of two, so a position maps to a cell with one AND
+    explicit MpmcQueue(size_t capacity)
+        : mask_(checked_capacity(capacity) - 1),
+          cells_(std::make_unique<cell[]>(capacity)) {
+        for (size_t i = 0; i < capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // value is left untouched if the queue is full
+    bool try_push(T&& value) {
+        cell* target;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            target = &cells_[pos & mask_];
+            size_t seq = target->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                                       std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        target->value = std::move(value);
+        target->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        cell* target;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            target = &cells_[pos & mask_];
+            size_t seq = target->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                                       std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(target->value);
+        // the cell becomes free for the producer one lap later
+        target->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push(T&& value) {
+        while (!try_push(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    T pop() {
+        T result;
+        while (!try_pop(result)) {
+            std::this_thread::yield();
+        }
+        return result;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    // only a hint while other threads are working with the queue
+    size_t size_approx() const {
+        size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+};
+
+using TaskQueue = MpmcQueue<MoveOnlyFunction<void()>>;
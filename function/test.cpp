@@ -1,25 +1,38 @@
+#include <array>
+#include <atomic>
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <typeinfo>
 #include <vector>
 
+#include "../stackallocator/stackallocator.h"
 #include "function.h"
+#include "task_queue.h"
+#include "thread_pool.h"
 
-int new_called = 0;
-int delete_called = 0;
+// the threaded tests allocate from several threads at once
+std::atomic<int> new_called = 0;
+std::atomic<int> delete_called = 0;
 
-void* operator new(size_t n) {
+// out of line: once inlined, g++ sees malloc paired with operator delete, or
+// operator new with free, and reports -Wmismatched-new-delete with optimization
+[[gnu::noinline]] void* operator new(size_t n) {
     ++new_called;
     return std::malloc(n);
 }
 
-void operator delete(void* ptr) noexcept {
+[[gnu::noinline]] void operator delete(void* ptr) noexcept {
     ++delete_called;
     std::free(ptr);
 }
 
-void operator delete(void* ptr, size_t) noexcept {
+[[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept {
     ++delete_called;
     std::free(ptr);
 }
@@ -323,6 +336,268 @@ TEST_CASE("MoveOnlyFunction") {
     test_function<MoveOnlyFunction, true>();
 }
 
+TEST_CASE("SharedFunction") {
+    test_function<SharedFunction, false>();
+
+    SECTION("Fan-out copies share the target") {
+        std::array<int, 16> payload{};
+        payload[15] = 42;
+        SharedFunction<int(int)> func = [payload](int x) { return payload[15] + x; };
+
+        std::vector<SharedFunction<int(int)>> subscribers;
+        subscribers.reserve(1000);
+
+        new_called = delete_called = 0;
+        for (int i = 0; i < 1000; ++i) {
+            subscribers.push_back(func);
+        }
+        REQUIRE(new_called == 0);
+        REQUIRE(subscribers[999](1) == 43);
+
+        subscribers.clear();
+        REQUIRE(delete_called == 0);
+        REQUIRE(func(0) == 42);
+    }
+
+    struct MutatingBig {
+        std::array<int, 16> counters{};
+        int operator()() {
+            return ++counters[0];
+        }
+    };
+    static_assert(!std::is_constructible_v<SharedFunction<int()>, MutatingBig>);
+    static_assert(std::is_constructible_v<Function<int()>, MutatingBig>);
+}
+
+TEST_CASE("Allocator-aware") {
+    StackStorage<1024> storage;
+    StackAllocator<char, 1024> alloc(storage);
+    std::array<int, 16> payload{};
+    payload[0] = 7;
+
+    SECTION("Big targets go to the arena") {
+        AllocatorGuard guard;
+        Function<int(int)> func(std::allocator_arg, alloc,
+                                [payload](int x) { return payload[0] * x; });
+        REQUIRE(func(6) == 42);
+
+        auto copy = func;
+        REQUIRE(copy(2) == 14);
+
+        Function<int(int)> moved = std::move(copy);
+        REQUIRE(moved(3) == 21);
+        REQUIRE(!copy);
+    }
+
+    SECTION("Small targets stay in the buffer") {
+        AllocatorGuard guard;
+        MoveOnlyFunction<int(int)> func(std::allocator_arg, alloc, [](int x) { return x + 1; });
+        REQUIRE(func(1) == 2);
+    }
+
+    SECTION("Shared storage") {
+        AllocatorGuard guard;
+        SharedFunction<int()> func(std::allocator_arg, alloc, [payload]() { return payload[0]; });
+        std::array<SharedFunction<int()>, 3> copies{func, func, func};
+        REQUIRE(copies[2]() == 7);
+    }
+}
+
+TEST_CASE("TaskQueue") {
+    SECTION("FIFO without allocations") {
+        TaskQueue queue(4);
+        int result = 0;
+
+        AllocatorGuard guard;
+        for (int i = 1; i <= 4; ++i) {
+            REQUIRE(queue.try_push([&result, i] { result = result * 10 + i; }));
+        }
+        REQUIRE(!queue.try_push([] {}));
+
+        MoveOnlyFunction<void()> task;
+        while (queue.try_pop(task)) {
+            task();
+        }
+        REQUIRE(result == 1234);
+        REQUIRE(queue.size_approx() == 0);
+    }
+
+    SECTION("Bad capacity") {
+        REQUIRE_THROWS_AS(TaskQueue(0), std::invalid_argument);
+        REQUIRE_THROWS_AS(TaskQueue(3), std::invalid_argument);
+        // rejected before anything is allocated for it
+        REQUIRE_THROWS_AS(TaskQueue(SIZE_MAX / 2 + 3), std::invalid_argument);
+    }
+
+    SECTION("Many producers and consumers") {
+        constexpr int kThreads = 4;
+        constexpr int kTasksPerProducer = 20'000;
+        TaskQueue queue(256);
+        std::atomic<int64_t> sum = 0;
+        std::atomic<int> done = 0;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&queue, &sum] {
+                for (int i = 1; i <= kTasksPerProducer; ++i) {
+                    queue.push([&sum, i] { sum += i; });
+                }
+            });
+            threads.emplace_back([&queue, &done] {
+                MoveOnlyFunction<void()> task;
+                while (done.load() < kThreads * kTasksPerProducer) {
+                    if (queue.try_pop(task)) {
+                        task();
+                        ++done;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(sum == int64_t{kThreads} * kTasksPerProducer * (kTasksPerProducer + 1) / 2);
+    }
+}
+
+TEST_CASE("Target and batched calls") {
+    SECTION("target") {
+        AllocatorGuard guard;
+        auto lambda = [](int x) { return x + 1; };
+        Function<int(int)> func = lambda;
+        REQUIRE(func.target_type() == typeid(lambda));
+        REQUIRE(func.target<decltype(lambda)>() != nullptr);
+        REQUIRE(func.target<int (*)(int)>() == nullptr);
+        REQUIRE((*func.target<decltype(lambda)>())(1) == 2);
+
+        Function<int(int, int)> pointer = sum;
+        REQUIRE(pointer.target_type() == typeid(&sum));
+        REQUIRE(*pointer.target<int (*)(int, int)>() == &sum);
+        // the target is a real pointer object, it can be written through
+        *pointer.target<int (*)(int, int)>() = +[](int a, int b) { return a * b; };
+        REQUIRE(pointer(2, 3) == 6);
+        Function<int(int, int)> copy = pointer;
+        Function<int(int, int)> moved = std::move(pointer);
+        REQUIRE(copy(2, 3) == 6);
+        REQUIRE(moved(2, 3) == 6);
+
+        Function<int(int, int)> empty;
+        REQUIRE(empty.target_type() == typeid(void));
+        REQUIRE(empty.target<int (*)(int, int)>() == nullptr);
+    }
+
+    SECTION("Big target") {
+        std::array<int, 16> payload{};
+        auto lambda = [payload](int x) { return payload[0] + x; };
+        MoveOnlyFunction<int(int)> func = lambda;
+        REQUIRE(func.target<decltype(lambda)>() != nullptr);
+
+        SharedFunction<int(int)> shared = lambda;
+        static_assert(std::is_same_v<decltype(shared.target<decltype(lambda)>()),
+                                     const decltype(lambda)*>);
+        REQUIRE(shared.target<decltype(lambda)>() != nullptr);
+    }
+
+    SECTION("invoke_n and for_each") {
+        int calls = 0;
+        auto counter = [&calls](int x) { calls += x; };
+        Function<void(int)> func = counter;
+
+        func.invoke_n<decltype(counter)>(10, 2);
+        REQUIRE(calls == 20);
+        func.invoke_n(5, 1);
+        REQUIRE(calls == 25);
+        // wrong type falls back to the generic path
+        func.invoke_n<int (*)(int)>(5, 1);
+        REQUIRE(calls == 30);
+
+        std::vector<int> values = {1, 2, 3};
+        func.for_each<decltype(counter)>(values.begin(), values.end());
+        func.for_each(values.begin(), values.end());
+        REQUIRE(calls == 42);
+
+        Function<void(int)> empty;
+        REQUIRE_THROWS_AS(empty.invoke_n(1, 1), std::bad_function_call);
+    }
+}
+
+int64_t parallel_sum(ThreadPool& pool, std::atomic<int64_t>& sum, int64_t from, int64_t to) {
+    if (to - from <= 64) {
+        int64_t local = 0;
+        for (int64_t i = from; i < to; ++i) {
+            local += i;
+        }
+        sum += local;
+        return 0;
+    }
+    int64_t mid = from + (to - from) / 2;
+    pool.post([&pool, &sum, from, mid] { parallel_sum(pool, sum, from, mid); });
+    pool.post([&pool, &sum, mid, to] { parallel_sum(pool, sum, mid, to); });
+    return 0;
+}
+
+TEST_CASE("ThreadPool") {
+    ThreadPool pool(4);
+    REQUIRE(pool.size() == 4);
+
+    SECTION("Submit") {
+        auto answer = pool.submit([] { return 42; });
+        auto owner = pool.submit([p = std::make_unique<int>(5)] { return *p; });
+        auto failed = pool.submit([]() -> int { throw std::runtime_error("oops"); });
+        REQUIRE(answer.get() == 42);
+        REQUIRE(owner.get() == 5);
+        REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+    }
+
+    SECTION("Nested tasks get stolen") {
+        constexpr int64_t kCount = 1 << 18;
+        std::atomic<int64_t> sum = 0;
+        std::thread::id poster;
+        std::atomic<bool> stolen = false;
+        pool.post([&pool, &sum, &poster, &stolen] {
+            poster = std::this_thread::get_id();
+            // slow enough that the idle workers take some of them
+            for (int i = 0; i < 64; ++i) {
+                pool.post([&poster, &stolen] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    if (std::this_thread::get_id() != poster) {
+                        stolen = true;
+                    }
+                });
+            }
+            parallel_sum(pool, sum, 0, kCount);
+        });
+        pool.wait_idle();
+        REQUIRE(sum == kCount * (kCount - 1) / 2);
+        REQUIRE(stolen);
+    }
+
+    SECTION("Throwing tasks") {
+        std::atomic<int> counter = 0;
+        pool.post([&pool, &counter] {
+            pool.post([] { throw std::runtime_error("nested"); });
+            ++counter;
+        });
+        for (int i = 0; i < 10'000; ++i) {
+            pool.post([&counter] { ++counter; });
+        }
+        // the pool goes on, and the exception comes out of wait_idle once
+        REQUIRE_THROWS_AS(pool.wait_idle(), std::runtime_error);
+        REQUIRE(counter == 10'001);
+        pool.wait_idle();
+    }
+
+    SECTION("Many external posts") {
+        std::atomic<int> counter = 0;
+        for (int i = 0; i < 100'000; ++i) {
+            pool.post([&counter] { ++counter; });
+        }
+        pool.wait_idle();
+        REQUIRE(counter == 100'000);
+    }
+}
 
 TEST_CASE("My1") {
 }
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "detail/work_stealing_deque.h"
+#include "function.h"
+#include "task_queue.h"
+
+// Work-stealing executor with MoveOnlyFunction<void()> as the unit of work.
+// Every worker owns a Chase-Lev deque: tasks posted from a worker go to its
+// own deque (LIFO, cache-warm), idle workers steal the oldest tasks from
+// the others. Tasks posted from outside go through a shared lock-free
+// TaskQueue.
+//
+// A posted task that throws doesn't take the pool down: the first such
+// exception is kept and rethrown by wait_idle(). Tasks from submit() report
+// theirs through the future.
+class ThreadPool {
+public:
+    using task = MoveOnlyFunction<void()>;
+
+private:
+    static constexpr size_t kCacheLine = 64;
+    static constexpr size_t kInjectionCapacity = 4096;
+    // emptied task objects a worker keeps for its next local posts
+    static constexpr size_t kSpareTasks = 256;
+
+    // The deque holds pointers, so a local post needs a task object of its
+    // own. The worker that runs a task empties it and keeps it in spare,
+    // and its next local post reuses it: a task with a small target costs
+    // no allocation once the pool has warmed up. Only the worker's own
+    // thread touches spare.
+    struct alignas(kCacheLine) worker {
+        WorkStealingDeque<task*> deque;
+        std::vector<std::unique_ptr<task>> spare;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<worker>> workers_;
+    TaskQueue injection_;
+
+    // queued but not yet taken by anybody, used to decide whether to sleep
+    alignas(kCacheLine) std::atomic<size_t> pending_{0};
+    // posted but not yet finished, used by wait_idle
+    alignas(kCacheLine) std::atomic<size_t> unfinished_{0};
+    std::atomic<size_t> sleeping_{0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable idle_cv_;
+    bool stop_ = false;
+    // the first exception of a posted task, guarded by mutex_
+    std::exception_ptr failure_;
+
+    static inline thread_local ThreadPool* current_pool_ = nullptr;
+    static inline thread_local size_t current_index_ = 0;
+
+    static uint64_t next_random() {
+        static thread_local uint64_t state =
+            std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    void enqueue(task&& work) {
+        unfinished_.fetch_add(1, std::memory_order_relaxed);
+        // counted before it is visible, so run() never sees the counter underflow
+        pending_.fetch_add(1, std::memory_order_seq_cst);
+        if (current_pool_ == this) {
+            worker& self = *workers_[current_index_];
+            std::unique_ptr<task> slot;
+            if (self.spare.empty()) {
+                slot = std::make_unique<task>(std::move(work));
+            } else {
+                slot = std::move(self.spare.back());
+                self.spare.pop_back();
+                *slot = std::move(work);
+            }
+            self.deque.push(slot.get());
+            slot.release();
+        } else {
+            // full injection queue: the producer helps instead of spinning
+            task other;
+            while (!injection_.try_push(std::move(work))) {
+                if (injection_.try_pop(other)) {
+                    run(other);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        if (sleeping_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard lock(mutex_);
+            wake_cv_.notify_one();
+        }
+    }
+
+    // never throws: the task may run inside an unrelated post(), and the
+    // counters have to come down whatever happens
+    void run(task& work) noexcept {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        try {
+            work();
+        } catch (...) {
+            std::lock_guard lock(mutex_);
+            if (!failure_) {
+                failure_ = std::current_exception();
+            }
+        }
+        if (unfinished_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard lock(mutex_);
+            idle_cv_.notify_all();
+        }
+    }
+
+    // runs a task from some deque on worker index and keeps the object
+    void run_owned(size_t index, task* owned) {
+        std::unique_ptr<task> holder(owned);
+        run(*holder);
+        auto& spare = workers_[index]->spare;
+        if (spare.size() < kSpareTasks) {
+            // the target goes now, not at the next post
+            *holder = task();
+            spare.push_back(std::move(holder));
+        }
+    }
+
+    bool try_run_one(size_t index) {
+        task* stolen = nullptr;
+        if (workers_[index]->deque.pop(stolen)) {
+            run_owned(index, stolen);
+            return true;
+        }
+
+        task injected;
+        if (injection_.try_pop(injected)) {
+            run(injected);
+            return true;
+        }
+
+        size_t count = workers_.size();
+        size_t start = next_random() % count;
+        for (size_t i = 0; i < count; ++i) {
+            size_t victim = (start + i) % count;
+            if (victim != index && workers_[victim]->deque.steal(stolen)) {
+                run_owned(index, stolen);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+        while (true) {
+            if (try_run_one(index)) {
+                continue;
+            }
+            std::unique_lock lock(mutex_);
+            sleeping_.fetch_add(1, std::memory_order_seq_cst);
+            wake_cv_.wait(lock, [this] {
+                return stop_ || pending_.load(std::memory_order_seq_cst) > 0;
+            });
+            sleeping_.fetch_sub(1, std::memory_order_relaxed);
+            if (stop_ && pending_.load(std::memory_order_seq_cst) == 0) {
+                return;
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+        : injection_(kInjectionCapacity) {
+        threads = std::max<size_t>(threads, 1);
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.push_back(std::make_unique<worker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers_[i]->thread = std::thread([this, i] { worker_loop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // finishes everything that was posted, then joins the workers
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_cv_.notify_all();
+        for (auto& w : workers_) {
+            w->thread.join();
+        }
+    }
+
+    size_t size() const {
+        return workers_.size();
+    }
+
+    // fire and forget
+    template <typename F>
+        requires std::invocable<std::decay_t<F>&>
+    void post(F&& func) {
+        enqueue(task(std::forward<F>(func)));
+    }
+
+    // the handle is a std::future, the task owns the promise, that's
+    // exactly what MoveOnlyFunction is for
+    template <typename F>
+        requires std::invocable<std::decay_t<F>&>
+    auto submit(F&& func) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        using result_t = std::invoke_result_t<std::decay_t<F>&>;
+        std::promise<result_t> promise;
+        auto future = promise.get_future();
+        enqueue(task([promise = std::move(promise), func = std::forward<F>(func)]() mutable {
+            try {
+                if constexpr (std::is_void_v<result_t>) {
+                    func();
+                    promise.set_value();
+                } else {
+                    promise.set_value(func());
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }));
+        return future;
+    }
+
+    // blocks until every posted task (including the ones they posted) is done,
+    // must not be called from a worker. Rethrows the first exception a posted
+    // task threw since the last call
+    void wait_idle() {
+        std::unique_lock lock(mutex_);
+        idle_cv_.wait(lock, [this] { return unfinished_.load(std::memory_order_acquire) == 0; });
+        if (failure_) {
+            std::rethrow_exception(std::exchange(failure_, nullptr));
+        }
+    }
+};
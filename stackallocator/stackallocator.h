@@ -1,3 +1,5 @@
+#pragma once
+
 #include <algorithm>
 #include <array>
 #include <cstddef>
@@ -6,6 +8,7 @@
 #include <iterator>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 template <size_t N>
 class StackStorage {
@@ -114,7 +117,7 @@ public:
     friend struct ListNode;
     using node_alloc_type = typename alloc_traits::template rebind_alloc<ListNode>;
     using node_alloc_traits = typename alloc_traits::template rebind_traits<ListNode>;
-    node_alloc_type allocator;
+    [[no_unique_address]] node_alloc_type allocator;
 
     template <bool is_const>
     class BaseIterator {
@@ -126,6 +129,8 @@ public:
         using pointer = typename std::conditional_t<is_const, const T*, T*>;
         using reference = typename std::conditional_t<is_const, const T&, T&>;
 
+        BaseIterator() = default;
+
         BaseIterator(const BaseIterator<false>& val)
             : node_(val.node_) {
         }
@@ -182,7 +187,7 @@ public:
         using node_dereferencable_type =
             typename std::conditional_t<is_const, const ListNode*, ListNode*>;
 
-        node_type node_;
+        node_type node_ = nullptr;
 
         explicit BaseIterator(node_type nd)
             : node_(nd) {
@@ -229,9 +234,9 @@ private:
         T value;
 
         template <typename... Args>
-        ListNode(BaseNode* prv, BaseNode* nxt, const Args&... args)
+        ListNode(BaseNode* prv, BaseNode* nxt, Args&&... args)
             : BaseNode(),
-              value(args...) {
+              value(std::forward<Args>(args)...) {
             BaseNode::link_between(prv, nxt);
         }
     };
@@ -241,7 +246,6 @@ public:
         return Allocator(allocator);  // вроде бы корректно??
     }
 
-private:
     void clear() {
         // Удаляет все, если все указатели правильны
         // И спасает от копипасты
@@ -250,7 +254,6 @@ private:
         }
     }
 
-public:
     explicit List(const Allocator& alloc)
         : allocator(alloc),
           root_() {
@@ -333,6 +336,12 @@ public:
         build_by_other_list(other);
     }
 
+    List(List&& other) noexcept
+        : allocator(std::move(other.allocator)),
+          root_() {
+        steal_nodes(other);
+    }
+
     List& operator=(const List& other) {
         if (this == &other) {
             return *this;
@@ -351,6 +360,39 @@ public:
         return *this;
     }
 
+    List& operator=(List&& other) noexcept(
+        node_alloc_traits::propagate_on_container_move_assignment::value ||
+        node_alloc_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+
+        clear();
+        if constexpr (node_alloc_traits::propagate_on_container_move_assignment::value) {
+            allocator = std::move(other.allocator);
+        } else if (!(allocator == other.allocator)) {
+            // чужую память забрать нельзя, перемещаем поэлементно
+            for (T& value : other) {
+                emplace_back(std::move(value));
+            }
+            other.clear();
+            return *this;
+        }
+        steal_nodes(other);
+        return *this;
+    }
+
+    void swap(List& other) noexcept {
+        std::swap(root_.prev, other.root_.prev);
+        std::swap(root_.next, other.root_.next);
+        std::swap(size_, other.size_);
+        fix_root();
+        other.fix_root();
+        if constexpr (node_alloc_traits::propagate_on_container_swap::value) {
+            std::swap(allocator, other.allocator);
+        }
+    }
+
     ~List() noexcept {
         clear();
     }
@@ -415,26 +457,45 @@ public:
         insert(cend(), val);
     };
 
+    void push_back(T&& val) {
+        insert(cend(), std::move(val));
+    }
+
     void push_front(const T& val) {
         insert(cbegin(), val);
     }
 
+    void push_front(T&& val) {
+        insert(cbegin(), std::move(val));
+    }
+
     template <typename... Args>
-    iterator emplace_target(iterator pos, const Args&... args) {
+    iterator emplace_target(iterator pos, Args&&... args) {
         ListNode* place = node_alloc_traits::allocate(allocator, 1);
-        size_++;
         try {
-            node_alloc_traits::construct(allocator, place, (pos.node_->prev), pos.node_, args...);
+            node_alloc_traits::construct(allocator, place, (pos.node_->prev), pos.node_,
+                                         std::forward<Args>(args)...);
         } catch (...) {
             node_alloc_traits::deallocate(allocator, place, 1);
             throw;
         }
+        size_++;
         return iterator(place);
     }
 
     template <typename... Args>
-    void emplace_back(const Args&... args) {
-        emplace_target(end(), args...);
+    iterator emplace(const_iterator pos, Args&&... args) {
+        return emplace_target(convert(pos), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args) {
+        emplace_target(end(), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void emplace_front(Args&&... args) {
+        emplace_target(begin(), std::forward<Args>(args)...);
     }
 
     void pop_back() {
@@ -466,7 +527,75 @@ public:
         return to_return;
     }
 
+    iterator erase(const_iterator first, const_iterator last) {
+        while (first != last) {
+            first = erase(first);
+        }
+        return convert(last);
+    }
+
     iterator insert(const_iterator pos, const T& value) {
         return emplace_target(convert(pos), value);
     }
+
+    iterator insert(const_iterator pos, T&& value) {
+        return emplace_target(convert(pos), std::move(value));
+    }
+
+    // Перевешивает узел it из other перед pos за O(1), ничего не аллоцируя.
+    // other может совпадать с *this; аллокаторы должны быть равны.
+    void splice(const_iterator pos, List& other, const_iterator it) {
+        BaseNode* node = const_cast<BaseNode*>(it.node_);
+        BaseNode* before = const_cast<BaseNode*>(pos.node_);
+        if (node == before || node->next == before) {
+            return;
+        }
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = before->prev;
+        node->next = before;
+        before->prev->next = node;
+        before->prev = node;
+        --other.size_;
+        ++size_;
+    }
+
+    // Перевешивает все узлы other перед pos за O(1)
+    void splice(const_iterator pos, List& other) {
+        if (&other == this || other.empty()) {
+            return;
+        }
+        BaseNode* before = const_cast<BaseNode*>(pos.node_);
+        BaseNode* first = other.root_.next;
+        BaseNode* last = other.root_.prev;
+        first->prev = before->prev;
+        last->next = before;
+        before->prev->next = first;
+        before->prev = last;
+        size_ += other.size_;
+        other.size_ = 0;
+        other.fix_root();
+    }
+
+private:
+    // Требует, чтобы *this был пуст
+    void steal_nodes(List& other) noexcept {
+        root_.prev = other.root_.prev;
+        root_.next = other.root_.next;
+        size_ = other.size_;
+        fix_root();
+        other.size_ = 0;
+        other.fix_root();
+    }
+
+    // Чинит ссылки соседей на root_ после того, как узлы поменяли владельца
+    void fix_root() noexcept {
+        if (size_ == 0) {
+            root_.prev = &root_;
+            root_.next = &root_;
+            return;
+        }
+        root_.prev->next = &root_;
+        root_.next->prev = &root_;
+    }
 };
\ No newline at end of file
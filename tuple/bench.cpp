@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "tuple.h"
+#include "tuple_vector.h"
+#include "util.h"
+
+template <typename Body>
+double measure(Body&& body) {
+    Timer timer;
+    body();
+    return std::chrono::duration<double, std::milli>(timer.GetTimes().wall_time).count();
+}
+
+// The same rows as a vector of tuples and as a TupleVector, scanned one
+// column at a time, as column-oriented queries do.
+int main() {
+    constexpr size_t kSize = 1'000'000;
+    std::mt19937 gen(42);
+    std::vector<Tuple<int, double, uint32_t>> tuples;
+    TupleVector<int, double, uint32_t> columns;
+    for (size_t i = 0; i < kSize; ++i) {
+        int id = static_cast<int>(gen() % 1000);
+        double price = static_cast<double>(gen() % 10'000) / 100;
+        uint32_t count = gen() % 100;
+        tuples.emplace_back(id, price, count);
+        columns.emplace_back(id, price, count);
+    }
+
+    double price_sum = 0;
+    uint64_t count_sum = 0;
+    double tuple_time = measure([&] {
+        for (int round = 0; round < 10; ++round) {
+            for (const auto& row : tuples) {
+                price_sum += get<1>(row);
+            }
+            for (const auto& row : tuples) {
+                count_sum += get<2>(row);
+            }
+        }
+    });
+    double column_time = measure([&] {
+        for (int round = 0; round < 10; ++round) {
+            for (double price : std::as_const(columns).column<1>()) {
+                price_sum += price;
+            }
+            for (uint32_t count : std::as_const(columns).column<2>()) {
+                count_sum += count;
+            }
+        }
+    });
+    std::cout << "10 x 2 column scans of " << kSize << " rows\n";
+    std::cout << "vector<Tuple>\tTupleVector (ms)\n";
+    std::cout << tuple_time << '\t' << column_time << "\t(" << price_sum << ' ' << count_sum
+              << ")\n";
+}
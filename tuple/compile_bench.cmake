@@ -0,0 +1,35 @@
+# Compiles compile_bench.cpp with tuples of every width in WIDTHS, prints the
+# build time and the object size of each, and appends them to
+# ${OUTPUT}/compile_bench_tuple.csv, so that the numbers can be compared
+# between commits. Run by the compile_bench_tuple target.
+#
+#   cmake -DCXX=<compiler> -DFLAGS=<flags> -DSOURCE=<compile_bench.cpp>
+#         -DOUTPUT=<dir> [-DWIDTHS=10;100;500] -P compile_bench.cmake
+
+if(NOT WIDTHS)
+  set(WIDTHS 10 100 500)
+endif()
+
+separate_arguments(FLAGS)
+get_filename_component(INCLUDE ${SOURCE} DIRECTORY)
+string(TIMESTAMP DATE "%Y-%m-%dT%H:%M:%S")
+set(LOG ${OUTPUT}/compile_bench_tuple.csv)
+if(NOT EXISTS ${LOG})
+  file(WRITE ${LOG} "date,width,milliseconds,bytes\n")
+endif()
+
+foreach(WIDTH ${WIDTHS})
+  set(OBJECT ${OUTPUT}/compile_bench_${WIDTH}.o)
+  string(TIMESTAMP START "%s%f")
+  execute_process(
+    COMMAND ${CXX} ${FLAGS} -I${INCLUDE} -DTUPLE_WIDTH=${WIDTH} -c ${SOURCE} -o ${OBJECT}
+    RESULT_VARIABLE RESULT)
+  string(TIMESTAMP FINISH "%s%f")
+  if(NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "width ${WIDTH}: the compiler failed: ${RESULT}")
+  endif()
+  math(EXPR MILLISECONDS "(${FINISH} - ${START}) / 1000")
+  file(SIZE ${OBJECT} BYTES)
+  message("width ${WIDTH}: ${MILLISECONDS} ms, ${BYTES} bytes")
+  file(APPEND ${LOG} "${DATE},${WIDTH},${MILLISECONDS},${BYTES}\n")
+endforeach()
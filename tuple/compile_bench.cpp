@@ -0,0 +1,46 @@
+// Compile-time benchmark: what a tuple of kWidth distinct types costs the
+// compiler, see compile_bench.cmake. Builds with -DTUPLE_WIDTH=<n>.
+
+#include <cstddef>
+#include <iostream>
+#include <utility>
+
+#include "tuple.h"
+
+#ifndef TUPLE_WIDTH
+#define TUPLE_WIDTH 100
+#endif
+
+constexpr size_t kWidth = TUPLE_WIDTH;
+
+template <size_t I>
+struct Field {
+    int value = static_cast<int>(I);
+
+    bool operator==(const Field&) const = default;
+};
+
+template <size_t... Is>
+auto make_wide(std::index_sequence<Is...>) -> Tuple<Field<Is>...>;
+
+using Wide = decltype(make_wide(std::make_index_sequence<kWidth>()));
+
+template <size_t... Is>
+auto make_half(std::index_sequence<Is...>) -> Tuple<Field<Is>...>;
+
+using Half = decltype(make_half(std::make_index_sequence<kWidth / 2>()));
+
+// every element by index and by type
+template <size_t... Is>
+int sum(const Wide& wide, std::index_sequence<Is...>) {
+    return (get<Is>(wide).value + ... + 0) + (get<Field<Is>>(wide).value + ... + 0);
+}
+
+int main() {
+    Wide wide;
+    Wide copy = wide;
+    get<kWidth - 1>(copy).value = 1;
+    auto cat = tupleCat(Half(), makeTuple(1, 2.5), std::move(copy));
+    std::cout << sum(wide, std::make_index_sequence<kWidth>()) << ' ' << (wide == copy) << ' '
+              << get<kWidth / 2>(cat) << '\n';
+}
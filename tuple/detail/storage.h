@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+// Elements of a Tuple: storage<index_sequence<0, ..., n>, T_0, ..., T_n>
+// inherits leaf<i, T_i> for every i at once, so a tuple of n elements is one
+// class with n bases, not n classes nested in each other, and the elements
+// come in the declared order in memory. Every element is a [[no_unique_address]]
+// member: stateless ones (allocators, deleters, comparators) take no space,
+// as empty bases would, and final classes and references need no special case.
+namespace tuple_detail {
+
+// tag of the constructors that take one argument per element
+struct elementwise_t {
+    explicit elementwise_t() = default;
+};
+
+inline constexpr elementwise_t kElementwise{};
+
+template <size_t I, typename T>
+struct leaf {
+    [[no_unique_address]] T value;
+
+    // value-initialized, so that Tuple<int> holds 0
+    constexpr leaf()
+        : value() {
+    }
+
+    template <typename U>
+    constexpr explicit leaf(elementwise_t, U&& arg)
+        : value(std::forward<U>(arg)) {
+    }
+};
+
+template <typename Indices, typename... Types>
+struct storage;
+
+template <size_t... Is, typename... Types>
+struct storage<std::index_sequence<Is...>, Types...> : leaf<Is, Types>... {
+    constexpr storage() = default;
+
+    template <typename... Us>
+    constexpr explicit storage(elementwise_t tag, Us&&... args)
+        : leaf<Is, Types>(tag, std::forward<Us>(args))... {
+    }
+};
+
+// leaf<I, T> is a base of the whole storage for exactly one T, deduction
+// finds it without walking the others
+template <size_t I, typename T>
+constexpr leaf<I, T>& element(leaf<I, T>& part) {
+    return part;
+}
+
+template <size_t I, typename T>
+constexpr const leaf<I, T>& element(const leaf<I, T>& part) {
+    return part;
+}
+
+}  // namespace tuple_detail
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <tuple>  // std::tuple_size, std::tuple_element
+#include <type_traits>
+#include <utility>
+
+#include "tuple.h"
+
+// Tuple<Types...> with the elements stored by alignment, so that there is no
+// padding between them: PackedTuple<char, double, char, int> takes 16 bytes
+// where Tuple<char, double, char, int> takes 24. get<I> and get<T> still count
+// in the declared order, only the layout differs.
+namespace packed_detail {
+
+// references are stored as pointers
+template <typename T>
+inline constexpr size_t kAlign = alignof(std::conditional_t<std::is_reference_v<T>, void*, T>);
+
+// stored element k is declared element order[k]. Alignment goes down from
+// the first one, so every element starts right where the previous one ends
+template <typename... Types>
+constexpr std::array<size_t, sizeof...(Types)> order() {
+    constexpr size_t kAligns[] = {kAlign<Types>..., 0};
+    std::array<size_t, sizeof...(Types)> result{};
+    for (size_t i = 0; i < sizeof...(Types); ++i) {
+        size_t j = i;
+        for (; j > 0 && kAligns[result[j - 1]] < kAligns[i]; --j) {
+            result[j] = result[j - 1];
+        }
+        result[j] = i;
+    }
+    return result;
+}
+
+// declared element i is stored element position[i]
+template <typename... Types>
+constexpr std::array<size_t, sizeof...(Types)> position() {
+    constexpr auto kOrder = order<Types...>();
+    std::array<size_t, sizeof...(Types)> result{};
+    for (size_t k = 0; k < sizeof...(Types); ++k) {
+        result[kOrder[k]] = k;
+    }
+    return result;
+}
+
+template <typename Indices, typename... Types>
+struct stored;
+
+template <size_t... Ks, typename... Types>
+struct stored<std::index_sequence<Ks...>, Types...> {
+    using type = Tuple<tuple_detail::type_at<order<Types...>()[Ks], Types...>...>;
+};
+
+// the only way into the storage from outside the class
+struct access {
+    template <size_t I, typename P>
+    static constexpr decltype(auto) get(P&& packed) {
+        constexpr size_t kAt = std::remove_cvref_t<P>::kPosition[I];
+        return ::get<kAt>(std::forward<P>(packed).storage_);
+    }
+};
+
+}  // namespace packed_detail
+
+template <typename... Types>
+class PackedTuple {
+    friend struct packed_detail::access;
+
+    static constexpr auto kOrder = packed_detail::order<Types...>();
+    static constexpr auto kPosition = packed_detail::position<Types...>();
+
+    typename packed_detail::stored<std::index_sequence_for<Types...>, Types...>::type storage_;
+
+    // args is a tuple of references in the declared order
+    template <typename Args, size_t... Ks>
+    constexpr PackedTuple(tuple_detail::from_tuple_t, Args args, std::index_sequence<Ks...>)
+        : storage_(get<kOrder[Ks]>(std::move(args))...) {
+    }
+
+public:
+    constexpr PackedTuple()
+        requires(std::is_default_constructible_v<Types> && ...)
+    = default;
+
+    template <typename... UTypes>
+        requires(sizeof...(UTypes) == sizeof...(Types)) && (sizeof...(Types) > 0) &&
+                tuple_detail::not_self<PackedTuple, UTypes...> &&
+                (std::is_constructible_v<Types, UTypes> && ...)
+    constexpr explicit(!(std::is_convertible_v<UTypes, Types> && ...))
+        PackedTuple(UTypes&&... args)
+        : PackedTuple(tuple_detail::kFromTuple, forwardAsTuple(std::forward<UTypes>(args)...),
+                      std::index_sequence_for<Types...>()) {
+    }
+};
+
+template <typename... Types>
+PackedTuple(Types...) -> PackedTuple<Types...>;
+
+template <typename... Types>
+struct std::tuple_size<PackedTuple<Types...>>
+    : std::integral_constant<size_t, sizeof...(Types)> {};
+
+template <size_t I, typename... Types>
+struct std::tuple_element<I, PackedTuple<Types...>> {
+    using type = tuple_detail::type_at<I, Types...>;
+};
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+constexpr tuple_detail::type_at<I, Types...>& get(PackedTuple<Types...>& tuple) {
+    return packed_detail::access::get<I>(tuple);
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+constexpr const tuple_detail::type_at<I, Types...>& get(const PackedTuple<Types...>& tuple) {
+    return packed_detail::access::get<I>(tuple);
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+constexpr tuple_detail::type_at<I, Types...>&& get(PackedTuple<Types...>&& tuple) {
+    return packed_detail::access::get<I>(std::move(tuple));
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+constexpr const tuple_detail::type_at<I, Types...>&& get(const PackedTuple<Types...>&& tuple) {
+    return packed_detail::access::get<I>(std::move(tuple));
+}
+
+template <typename T, typename... Types>
+    requires tuple_detail::occurs_once<T, Types...>
+constexpr T& get(PackedTuple<Types...>& tuple) {
+    return get<tuple_detail::index_of<T, Types...>()>(tuple);
+}
+
+template <typename T, typename... Types>
+    requires tuple_detail::occurs_once<T, Types...>
+constexpr const T& get(const PackedTuple<Types...>& tuple) {
+    return get<tuple_detail::index_of<T, Types...>()>(tuple);
+}
+
+template <typename T, typename... Types>
+    requires tuple_detail::occurs_once<T, Types...>
+constexpr T&& get(PackedTuple<Types...>&& tuple) {
+    return get<tuple_detail::index_of<T, Types...>()>(std::move(tuple));
+}
+
+template <typename T, typename... Types>
+    requires tuple_detail::occurs_once<T, Types...>
+constexpr const T&& get(const PackedTuple<Types...>&& tuple) {
+    return get<tuple_detail::index_of<T, Types...>()>(std::move(tuple));
+}
+
+template <typename... Types>
+constexpr bool operator==(const PackedTuple<Types...>& lhs, const PackedTuple<Types...>& rhs) {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return (static_cast<bool>(get<Is>(lhs) == get<Is>(rhs)) && ...);
+    }(std::index_sequence_for<Types...>());
+}
+
+// lexicographic in the declared order, not in the stored one
+template <typename... Types>
+constexpr std::common_comparison_category_t<tuple_detail::synth_three_way_t<Types, Types>...>
+operator<=>(const PackedTuple<Types...>& lhs, const PackedTuple<Types...>& rhs) {
+    using R = std::common_comparison_category_t<tuple_detail::synth_three_way_t<Types, Types>...>;
+    R result = R::equivalent;
+    [&]<size_t... Is>(std::index_sequence<Is...>) {
+        static_cast<void>(
+            (((result = tuple_detail::synth_three_way()(get<Is>(lhs), get<Is>(rhs))) == 0) && ...));
+    }(std::index_sequence_for<Types...>());
+    return result;
+}
@@ -1,10 +1,16 @@
 #include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "packed_tuple.h"
 #include "tuple.h"
+#include "tuple_vector.h"
 
 // #include <tuple>
 
@@ -572,4 +578,211 @@ TEST_CASE("Helpers") {
         REQUIRE(Accountant::move_constructed == 3);
         REQUIRE(Accountant::copy_constructed == 5);
     }
+
+    SECTION("NoExtraCopies") {
+        InitCounters();
+        Accountant accountant;
+
+        // an lvalue is copied once and an rvalue moved once, straight into place
+        auto made = makeTuple(accountant, Accountant());
+        REQUIRE(Accountant::copy_constructed == 1);
+        REQUIRE(Accountant::move_constructed == 1);
+
+        int constructed = Accountant::constructed;
+        auto tied = tie(accountant);
+        auto forwarded = forwardAsTuple(accountant, std::move(accountant));
+        REQUIRE(&get<0>(tied) == &accountant);
+        REQUIRE(&get<1>(forwarded) == &accountant);
+        REQUIRE(Accountant::constructed == constructed);
+
+        // the elements of rvalue tuples are moved once more, references stay
+        auto cat = tupleCat(std::move(made), makeTuple(Accountant()), tied);
+        REQUIRE(&get<3>(cat) == &accountant);
+        REQUIRE(Accountant::copy_constructed == 1);
+        REQUIRE(Accountant::move_constructed == 5);
+        REQUIRE(Accountant::copy_assigned + Accountant::move_assigned == 0);
+    }
+
+    SECTION("Constexpr") {
+        constexpr auto kCat = tupleCat(makeTuple(1, 2.5), Tuple<char>('c'), makeTuple());
+        static_assert(get<0>(kCat) == 1 && get<1>(kCat) == 2.5 && get<char>(kCat) == 'c');
+        static_assert(kCat == makeTuple(1, 2.5, 'c'));
+
+        constexpr auto kSwapped = [] {
+            int first = 1;
+            int second = 2;
+            tie(first, second) = makeTuple(second, first);
+            return makeTuple(first, second);
+        }();
+        static_assert(kSwapped == makeTuple(2, 1));
+    }
+}
+
+struct Deleter {
+    void operator()(int* ptr) const {
+        delete ptr;
+    }
+};
+
+struct FinalLess final : std::less<int> {};
+
+TEST_CASE("EmptyMembers") {
+    // stateless members take no space
+    static_assert(sizeof(Tuple<std::allocator<int>, std::less<>, int*>) == sizeof(int*));
+    static_assert(sizeof(Tuple<int*, Deleter>) == sizeof(int*));
+    static_assert(sizeof(Tuple<FinalLess, double>) == sizeof(double));
+    static_assert(sizeof(Tuple<std::less<>, std::greater<>, int>) == sizeof(int));
+    // two objects of one type still need two addresses
+    Tuple<std::less<>, std::less<>, int> twins;
+    REQUIRE(static_cast<void*>(&get<0>(twins)) != static_cast<void*>(&get<1>(twins)));
+
+    Tuple<int*, Deleter> owner(new int(5), Deleter());
+    get<Deleter>(owner)(get<int*>(owner));
+
+    Tuple<std::less<>, std::equal_to<>, std::hash<int>> functors;
+    REQUIRE(get<0>(functors)(1, 2));
+    REQUIRE(get<std::equal_to<>>(functors)(3, 3));
+
+    REQUIRE(makeTuple(1, 2.5) == makeTuple(1, 2.5));
+    REQUIRE(makeTuple(1, 2.5) < makeTuple(1, 3));
+    REQUIRE(makeTuple(2, std::string("a")) > makeTuple(1, std::string("b")));
+    REQUIRE(std::is_eq(makeTuple(1, 2.0) <=> makeTuple(1, 2)));
+    auto [x, y] = makeTuple(1, std::string("two"));
+    REQUIRE(x + y.size() == 4);
+}
+
+struct Point {
+    int x;
+    double y;
+};
+
+TEST_CASE("TriviallyCopyable") {
+    static_assert(std::is_trivially_copyable_v<Tuple<int, double, char>>);
+    static_assert(std::is_trivially_copyable_v<Tuple<Point, std::less<>, int*>>);
+    static_assert(std::is_trivially_copyable_v<PackedTuple<char, double, int>>);
+    static_assert(std::is_trivially_copyable_v<Tuple<>>);
+    static_assert(!std::is_trivially_copyable_v<Tuple<int, std::string>>);
+    // assignment goes through the references
+    static_assert(!std::is_trivially_copyable_v<Tuple<int&, double>>);
+    static_assert(!std::is_copy_assignable_v<Tuple<const int, double>>);
+
+    Tuple<int, Point, char> source(1, Point{2, 3.5}, 'c');
+    Tuple<int, Point, char> target;
+    std::memcpy(&target, &source, sizeof(source));
+    REQUIRE(get<1>(target).y == 3.5);
+    REQUIRE(get<char>(target) == 'c');
+
+    target = Tuple<int, Point, char>(4, Point{5, 6.5}, 'd');
+    REQUIRE(get<0>(target) == 4);
+    source = target;
+    REQUIRE(get<Point>(source).x == 5);
+
+    std::vector<Tuple<int, double>> rows(3, Tuple<int, double>(1, 2.5));
+    rows.reserve(100);
+    REQUIRE(get<double>(rows[2]) == 2.5);
+}
+
+TEST_CASE("PackedTuple") {
+    static_assert(sizeof(Tuple<char, double, char, int>) == 24);
+    static_assert(sizeof(PackedTuple<char, double, char, int>) == 16);
+    static_assert(sizeof(PackedTuple<char, std::less<>, int16_t, int64_t>) == 16);
+
+    PackedTuple<char, double, char, int> packed('a', 2.5, 'b', 4);
+    REQUIRE(get<0>(packed) == 'a');
+    REQUIRE(get<1>(packed) == 2.5);
+    REQUIRE(get<2>(packed) == 'b');
+    REQUIRE(get<int>(packed) == 4);
+    get<double>(packed) = 3.5;
+    REQUIRE(get<1>(std::as_const(packed)) == 3.5);
+    static_assert(std::is_same_v<decltype(get<1>(std::move(packed))), double&&>);
+
+    // the declared order decides
+    PackedTuple<char, int64_t> less('a', 2);
+    PackedTuple<char, int64_t> greater('b', 1);
+    REQUIRE(less < greater);
+    REQUIRE(less == PackedTuple<char, int64_t>('a', 2));
+
+    InitCounters();
+    {
+        Accountant accountant;
+        int value = 1;
+        PackedTuple<Accountant, int&, char> refs(accountant, value, 'c');
+        get<int&>(refs) = 2;
+        REQUIRE(value == 2);
+        PackedTuple<Accountant, int&, char> copy = refs;
+        PackedTuple<Accountant, int&, char> moved = std::move(refs);
+        REQUIRE(Accountant::copy_constructed == 2);
+        REQUIRE(Accountant::move_constructed == 1);
+    }
+    REQUIRE(Accountant::destructed == 4);
+
+    PackedTuple<std::string, NeitherDefaultNorCopyConstructible> only_movable("moved", 1.5);
+    auto [text, _] = std::move(only_movable);
+    REQUIRE(text == "moved");
+}
+
+struct ThrowsOnCopy {
+    ThrowsOnCopy() = default;
+    ThrowsOnCopy(const ThrowsOnCopy&) {
+        throw std::runtime_error("copy");
+    }
+};
+
+TEST_CASE("TupleVector") {
+    TupleVector<int, double, uint32_t> rows;
+    REQUIRE(rows.empty());
+    rows.push_back(makeTuple(1, 1.5, 10u));
+    rows.emplace_back(2, 2.5, 20u);
+    Tuple<int, double, uint32_t> third(3, 3.5, 30);
+    rows.push_back(third);
+    REQUIRE(rows.size() == 3);
+
+    // rows are tuples of references into the columns
+    static_assert(std::is_same_v<decltype(rows[0]), Tuple<int&, double&, uint32_t&>>);
+    REQUIRE(get<1>(rows[1]) == 2.5);
+    REQUIRE(get<uint32_t&>(rows[2]) == 30);
+    REQUIRE(rows[2] == third);
+    get<0>(rows[0]) = 10;
+    rows[1] = makeTuple(20, 4.5, 40u);
+    auto [id, weight, count] = rows[1];
+    REQUIRE(id == 20);
+    REQUIRE(weight == 4.5);
+    ++count;
+    Tuple<int, double, uint32_t> copy = rows[1];
+    REQUIRE(get<2>(copy) == 41);
+
+    // columns are contiguous
+    REQUIRE(rows.column<0>().data() + 1 == &get<0>(rows[1]));
+    double total = 0;
+    for (double value : rows.column<double>()) {
+        total += value;
+    }
+    REQUIRE(total == 1.5 + 4.5 + 3.5);
+    for (uint32_t& value : rows.column<2>()) {
+        value *= 2;
+    }
+    REQUIRE(get<2>(rows[2]) == 60);
+
+    int ids = 0;
+    for (auto row : std::as_const(rows)) {
+        static_assert(std::is_same_v<decltype(row), Tuple<const int&, const double&,
+                                                          const uint32_t&>>);
+        ids += get<const int&>(row);
+    }
+    REQUIRE(ids == 33);
+    static_assert(std::forward_iterator<decltype(rows.begin())>);
+
+    rows.pop_back();
+    REQUIRE(rows.size() == 2);
+    REQUIRE(get<0>(rows.back()) == 20);
+    rows.clear();
+    REQUIRE(rows.column<int>().empty());
+
+    // a failed row leaves no column longer than the others
+    TupleVector<std::string, ThrowsOnCopy> strings;
+    ThrowsOnCopy thrower;
+    REQUIRE_THROWS_AS(strings.emplace_back("text", thrower), std::runtime_error);
+    REQUIRE(strings.empty());
+    REQUIRE(strings.column<std::string>().empty());
+    REQUIRE(strings.column<ThrowsOnCopy>().empty());
 }
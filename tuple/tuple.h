@@ -1,5 +1,450 @@
-template <typename... Args>
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <tuple>  // std::tuple_size, std::tuple_element
+#include <type_traits>
+#include <utility>
+
+#include "detail/storage.h"
+
+template <typename... Types>
+class Tuple;
+
+namespace tuple_detail {
+
+// T_I is found the way the element I of a Tuple is: by deduction of the one
+// base indexed<I, T> of the indexer, without walking the others
+// (GCC 12 can't tell int& from int&& in a deduced base without the flag)
+template <size_t I, typename T, bool Rvalue = std::is_rvalue_reference_v<T>>
+struct indexed {
+    using type = T;
+};
+
+template <typename Indices, typename... Types>
+struct indexer;
+
+template <size_t... Is, typename... Types>
+struct indexer<std::index_sequence<Is...>, Types...> : indexed<Is, Types>... {};
+
+template <typename... Types>
+using indexer_for = indexer<std::index_sequence_for<Types...>, Types...>;
+
+template <size_t I, typename T, bool Rvalue>
+indexed<I, T, Rvalue> select(indexed<I, T, Rvalue>);
+
+template <size_t I, typename... Types>
+using type_at = typename decltype(select<I>(indexer_for<Types...>()))::type;
+
+// deduction fails when T is not among Types or is there more than once
+template <typename T, size_t I>
+std::integral_constant<size_t, I> find(indexed<I, T>);
+
+template <typename T, typename... Types>
+concept occurs_once = requires { find<T>(indexer_for<Types...>()); };
+
+template <typename T, typename... Types>
+constexpr size_t index_of() {
+    return decltype(find<T>(indexer_for<Types...>()))::value;
+}
+
+// T x = {}; compiles
+template <typename T>
+concept implicitly_default_constructible = requires(void (*f)(const T&)) { f({}); };
+
+// concepts over the whole pack, so that the trivial assignments of Tuple
+// subsume the general ones
+template <typename... Types>
+concept all_copy_assignable = (std::is_copy_assignable_v<Types> && ...);
+
+template <typename... Types>
+concept all_move_assignable = (std::is_move_assignable_v<Types> && ...);
+
+// a reference is assigned through, which the defaulted operator= can't do
+template <typename... Types>
+concept all_objects = (!std::is_reference_v<Types> && ...);
+
+template <typename... Types>
+concept all_trivially_copy_assignable =
+    all_objects<Types...> && (std::is_trivially_copy_assignable_v<Types> && ...);
+
+template <typename... Types>
+concept all_trivially_move_assignable =
+    all_objects<Types...> && (std::is_trivially_move_assignable_v<Types> && ...);
+
+// Tuple<T>(U&&) is not the copy or the move constructor
+template <typename Self, typename... UTypes>
+concept not_self =
+    sizeof...(UTypes) != 1 || !(std::is_same_v<std::remove_cvref_t<UTypes>, Self> && ...);
+
+// Tuple<T> is built from Tuple<U> element by element only when T can't take
+// the whole other tuple
+template <typename Other, typename T, typename U>
+concept unwraps =
+    !std::is_convertible_v<Other, T> && !std::is_constructible_v<T, Other> && !std::is_same_v<T, U>;
+
+// conditions for a pair of elements P1 and P2 (references, as passed)
+template <typename P1, typename P2, typename... Types>
+struct pair_traits {
+    static constexpr bool kConstructible = false;
+    static constexpr bool kConvertible = false;
+    static constexpr bool kAssignable = false;
+};
+
+template <typename P1, typename P2, typename T1, typename T2>
+struct pair_traits<P1, P2, T1, T2> {
+    static constexpr bool kConstructible =
+        std::is_constructible_v<T1, P1> && std::is_constructible_v<T2, P2>;
+    static constexpr bool kConvertible =
+        std::is_convertible_v<P1, T1> && std::is_convertible_v<P2, T2>;
+    static constexpr bool kAssignable =
+        std::is_assignable_v<T1&, P1> && std::is_assignable_v<T2&, P2>;
+};
+
+// tag of the constructor that takes the elements of another tuple
+struct from_tuple_t {
+    explicit from_tuple_t() = default;
+};
+
+inline constexpr from_tuple_t kFromTuple{};
+
+// the only way into the storage from outside the class
+struct access {
+    template <size_t I, typename T>
+    static constexpr auto& element(T& tuple) {
+        return tuple_detail::element<I>(tuple.storage_);
+    }
+};
+
+template <typename T>
+struct size_of;
+
+template <typename... Types>
+struct size_of<Tuple<Types...>> : std::integral_constant<size_t, sizeof...(Types)> {};
+
+template <typename T>
+inline constexpr size_t kSize = size_of<std::remove_cvref_t<T>>::value;
+
+}  // namespace tuple_detail
+
+template <typename... Types>
 class Tuple {
+    friend struct tuple_detail::access;
+
+    tuple_detail::storage<std::index_sequence_for<Types...>, Types...> storage_;
+
+    template <typename Other, size_t... Is>
+    constexpr Tuple(tuple_detail::from_tuple_t, Other&& other, std::index_sequence<Is...>)
+        : storage_(tuple_detail::kElementwise, get<Is>(std::forward<Other>(other))...) {
+    }
+
+    // element i = get<i>(FWD(other))
+    template <typename Other, size_t... Is>
+    constexpr void assign(Other&& other, std::index_sequence<Is...>) {
+        (static_cast<void>(get<Is>(*this) = get<Is>(std::forward<Other>(other))), ...);
+    }
+
+public:
+    constexpr explicit((!tuple_detail::implicitly_default_constructible<Types> || ...)) Tuple()
+        requires(std::is_default_constructible_v<Types> && ...)
+    {
+    }
+
+    constexpr explicit(!(std::is_convertible_v<const Types&, Types> && ...))
+        Tuple(const Types&... args)
+        requires(sizeof...(Types) > 0) && (std::is_copy_constructible_v<Types> && ...)
+        : storage_(tuple_detail::kElementwise, args...) {
+    }
+
+    template <typename... UTypes>
+        requires(sizeof...(UTypes) == sizeof...(Types)) && (sizeof...(Types) > 0) &&
+                tuple_detail::not_self<Tuple, UTypes...> &&
+                (std::is_constructible_v<Types, UTypes> && ...)
+    constexpr explicit(!(std::is_convertible_v<UTypes, Types> && ...)) Tuple(UTypes&&... args)
+        : storage_(tuple_detail::kElementwise, std::forward<UTypes>(args)...) {
+    }
+
+    template <typename... UTypes>
+        requires(sizeof...(UTypes) == sizeof...(Types)) &&
+                (std::is_constructible_v<Types, const UTypes&> && ...) &&
+                (sizeof...(Types) != 1 ||
+                 (tuple_detail::unwraps<const Tuple<UTypes...>&, Types, UTypes> && ...))
+    constexpr explicit(!(std::is_convertible_v<const UTypes&, Types> && ...))
+        Tuple(const Tuple<UTypes...>& other)
+        : Tuple(tuple_detail::kFromTuple, other, std::index_sequence_for<Types...>()) {
+    }
+
+    template <typename... UTypes>
+        requires(sizeof...(UTypes) == sizeof...(Types)) &&
+                (std::is_constructible_v<Types, UTypes&&> && ...) &&
+                (sizeof...(Types) != 1 ||
+                 (tuple_detail::unwraps<Tuple<UTypes...>&&, Types, UTypes> && ...))
+    constexpr explicit(!(std::is_convertible_v<UTypes&&, Types> && ...))
+        Tuple(Tuple<UTypes...>&& other)
+        : Tuple(tuple_detail::kFromTuple, std::move(other), std::index_sequence_for<Types...>()) {
+    }
+
+    template <typename U1, typename U2>
+        requires tuple_detail::pair_traits<const U1&, const U2&, Types...>::kConstructible
+    constexpr explicit(!tuple_detail::pair_traits<const U1&, const U2&, Types...>::kConvertible)
+        Tuple(const std::pair<U1, U2>& pair)
+        : storage_(tuple_detail::kElementwise, pair.first, pair.second) {
+    }
+
+    template <typename U1, typename U2>
+        requires tuple_detail::pair_traits<U1&&, U2&&, Types...>::kConstructible
+    constexpr explicit(!tuple_detail::pair_traits<U1&&, U2&&, Types...>::kConvertible)
+        Tuple(std::pair<U1, U2>&& pair)
+        : storage_(tuple_detail::kElementwise, std::forward<U1>(pair.first),
+                   std::forward<U2>(pair.second)) {
+    }
+
+    constexpr Tuple(const Tuple&) = default;
+    constexpr Tuple(Tuple&&) = default;
+
+    // with trivial elements Tuple is trivially copyable itself: it can be
+    // memcpy'd, and vectors of it copy and relocate with memmove
+    constexpr Tuple& operator=(const Tuple&)
+        requires tuple_detail::all_copy_assignable<Types...> &&
+                 tuple_detail::all_trivially_copy_assignable<Types...>
+    = default;
+
+    constexpr Tuple& operator=(Tuple&&)
+        requires tuple_detail::all_move_assignable<Types...> &&
+                 tuple_detail::all_trivially_move_assignable<Types...>
+    = default;
+
+    // elements are assigned one by one: references assign the objects they
+    // refer to
+    constexpr Tuple& operator=(const Tuple& other)
+        requires tuple_detail::all_copy_assignable<Types...>
+    {
+        assign(other, std::index_sequence_for<Types...>());
+        return *this;
+    }
+
+    constexpr Tuple& operator=(Tuple&& other) noexcept(
+        (std::is_nothrow_move_assignable_v<Types> && ...))
+        requires tuple_detail::all_move_assignable<Types...>
+    {
+        assign(std::move(other), std::index_sequence_for<Types...>());
+        return *this;
+    }
+
+    template <typename... UTypes>
+        requires(sizeof...(UTypes) == sizeof...(Types)) &&
+                (std::is_assignable_v<Types&, const UTypes&> && ...)
+    constexpr Tuple& operator=(const Tuple<UTypes...>& other) {
+        assign(other, std::index_sequence_for<Types...>());
+        return *this;
+    }
+
+    template <typename... UTypes>
+        requires(sizeof...(UTypes) == sizeof...(Types)) &&
+                (std::is_assignable_v<Types&, UTypes> && ...)
+    constexpr Tuple& operator=(Tuple<UTypes...>&& other) {
+        assign(std::move(other), std::index_sequence_for<Types...>());
+        return *this;
+    }
+
+    template <typename U1, typename U2>
+        requires tuple_detail::pair_traits<const U1&, const U2&, Types...>::kAssignable
+    constexpr Tuple& operator=(const std::pair<U1, U2>& pair) {
+        get<0>(*this) = pair.first;
+        get<1>(*this) = pair.second;
+        return *this;
+    }
+
+    template <typename U1, typename U2>
+        requires tuple_detail::pair_traits<U1&&, U2&&, Types...>::kAssignable
+    constexpr Tuple& operator=(std::pair<U1, U2>&& pair) {
+        get<0>(*this) = std::forward<U1>(pair.first);
+        get<1>(*this) = std::forward<U2>(pair.second);
+        return *this;
+    }
+};
+
+template <typename... Types>
+Tuple(Types...) -> Tuple<Types...>;
+
+template <typename T1, typename T2>
+Tuple(std::pair<T1, T2>) -> Tuple<T1, T2>;
+
+template <typename... Types>
+struct std::tuple_size<Tuple<Types...>> : std::integral_constant<size_t, sizeof...(Types)> {};
+
+template <size_t I, typename... Types>
+struct std::tuple_element<I, Tuple<Types...>> {
+    using type = tuple_detail::type_at<I, Types...>;
+};
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+constexpr tuple_detail::type_at<I, Types...>& get(Tuple<Types...>& tuple) {
+    return tuple_detail::access::element<I>(tuple).value;
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+constexpr const tuple_detail::type_at<I, Types...>& get(const Tuple<Types...>& tuple) {
+    return tuple_detail::access::element<I>(tuple).value;
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+constexpr tuple_detail::type_at<I, Types...>&& get(Tuple<Types...>&& tuple) {
+    return static_cast<tuple_detail::type_at<I, Types...>&&>(
+        tuple_detail::access::element<I>(tuple).value);
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+constexpr const tuple_detail::type_at<I, Types...>&& get(const Tuple<Types...>&& tuple) {
+    return static_cast<const tuple_detail::type_at<I, Types...>&&>(
+        tuple_detail::access::element<I>(tuple).value);
+}
+
+template <typename T, typename... Types>
+    requires tuple_detail::occurs_once<T, Types...>
+constexpr T& get(Tuple<Types...>& tuple) {
+    return get<tuple_detail::index_of<T, Types...>()>(tuple);
+}
+
+template <typename T, typename... Types>
+    requires tuple_detail::occurs_once<T, Types...>
+constexpr const T& get(const Tuple<Types...>& tuple) {
+    return get<tuple_detail::index_of<T, Types...>()>(tuple);
+}
+
+template <typename T, typename... Types>
+    requires tuple_detail::occurs_once<T, Types...>
+constexpr T&& get(Tuple<Types...>&& tuple) {
+    return get<tuple_detail::index_of<T, Types...>()>(std::move(tuple));
+}
+
+template <typename T, typename... Types>
+    requires tuple_detail::occurs_once<T, Types...>
+constexpr const T&& get(const Tuple<Types...>&& tuple) {
+    return get<tuple_detail::index_of<T, Types...>()>(std::move(tuple));
+}
+
+template <typename... Types>
+constexpr Tuple<std::unwrap_ref_decay_t<Types>...> makeTuple(Types&&... args) {
+    return Tuple<std::unwrap_ref_decay_t<Types>...>(std::forward<Types>(args)...);
+}
+
+template <typename... Types>
+constexpr Tuple<Types&...> tie(Types&... args) {
+    return Tuple<Types&...>(args...);
+}
+
+template <typename... Types>
+constexpr Tuple<Types&&...> forwardAsTuple(Types&&... args) {
+    return Tuple<Types&&...>(std::forward<Types>(args)...);
+}
+
+namespace tuple_detail {
+
+template <typename... Tuples>
+struct concat;
+
+template <>
+struct concat<> {
+    using type = Tuple<>;
+};
+
+template <typename... Types>
+struct concat<Tuple<Types...>> {
+    using type = Tuple<Types...>;
+};
+
+template <typename... Ts, typename... Us, typename... Rest>
+struct concat<Tuple<Ts...>, Tuple<Us...>, Rest...> : concat<Tuple<Ts..., Us...>, Rest...> {};
+
+// element k of the concatenation is element inner[k] of tuple outer[k]
+template <size_t... Sizes>
+struct cat_indices {
+    static constexpr size_t kTotal = (Sizes + ... + 0);
+
+    std::array<size_t, kTotal> outer{};
+    std::array<size_t, kTotal> inner{};
+
+    constexpr cat_indices() {
+        constexpr size_t kSizes[] = {Sizes..., 0};
+        size_t k = 0;
+        for (size_t i = 0; i < sizeof...(Sizes); ++i) {
+            for (size_t j = 0; j < kSizes[i]; ++j, ++k) {
+                outer[k] = i;
+                inner[k] = j;
+            }
+        }
+    }
+};
+
+// built once, not once per element of the result
+template <size_t... Sizes>
+inline constexpr cat_indices<Sizes...> kCatIndices{};
+
+}  // namespace tuple_detail
+
+// Every element is copied (from an lvalue tuple) or moved (from an rvalue
+// one) once, straight into the result: the arguments are only referred to.
+template <typename... Tuples>
+constexpr typename tuple_detail::concat<std::remove_cvref_t<Tuples>...>::type tupleCat(
+    Tuples&&... tuples) {
+    using Result = typename tuple_detail::concat<std::remove_cvref_t<Tuples>...>::type;
+    constexpr auto& kIndices = tuple_detail::kCatIndices<tuple_detail::kSize<Tuples>...>;
+    auto all = forwardAsTuple(std::forward<Tuples>(tuples)...);
+    return [&all]<size_t... Ks>(std::index_sequence<Ks...>) {
+        return Result(get<kIndices.inner[Ks]>(get<kIndices.outer[Ks]>(std::move(all)))...);
+    }(std::make_index_sequence<kIndices.kTotal>());
+}
+
+namespace tuple_detail {
+
+// <=> where there is one, otherwise made of <, as for std::tuple
+struct synth_three_way {
+    template <typename T, typename U>
+    constexpr auto operator()(const T& lhs, const U& rhs) const {
+        if constexpr (std::three_way_comparable_with<T, U>) {
+            return lhs <=> rhs;
+        } else {
+            if (lhs < rhs) {
+                return std::weak_ordering::less;
+            }
+            if (rhs < lhs) {
+                return std::weak_ordering::greater;
+            }
+            return std::weak_ordering::equivalent;
+        }
+    }
+};
+
+template <typename T, typename U>
+using synth_three_way_t =
+    decltype(synth_three_way()(std::declval<const T&>(), std::declval<const U&>()));
+
+}  // namespace tuple_detail
+
+template <typename... Types, typename... UTypes>
+    requires(sizeof...(Types) == sizeof...(UTypes))
+constexpr bool operator==(const Tuple<Types...>& lhs, const Tuple<UTypes...>& rhs) {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return (static_cast<bool>(get<Is>(lhs) == get<Is>(rhs)) && ...);
+    }(std::index_sequence_for<Types...>());
+}
 
-    // YOUR CODE HERE
-};
\ No newline at end of file
+// lexicographic: the first elements that differ decide
+template <typename... Types, typename... UTypes>
+    requires(sizeof...(Types) == sizeof...(UTypes))
+constexpr std::common_comparison_category_t<tuple_detail::synth_three_way_t<Types, UTypes>...>
+operator<=>(const Tuple<Types...>& lhs, const Tuple<UTypes...>& rhs) {
+    using R = std::common_comparison_category_t<tuple_detail::synth_three_way_t<Types, UTypes>...>;
+    R result = R::equivalent;
+    [&]<size_t... Is>(std::index_sequence<Is...>) {
+        static_cast<void>(
+            (((result = tuple_detail::synth_three_way()(get<Is>(lhs), get<Is>(rhs))) == 0) && ...));
+    }(std::index_sequence_for<Types...>());
+    return result;
+}
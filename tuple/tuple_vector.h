@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tuple.h"
+
+// A sequence of Tuple<Types...> rows stored as a structure of arrays: every
+// element type has its own contiguous vector. A scan over one column reads
+// only that column, with no stride and no padding between the values, so the
+// compiler can vectorize it; column<I>() gives it as a span.
+//
+// Rows are proxies: v[i] is a Tuple<Types&...> into the columns, so get<I>,
+// structured bindings, comparisons and assignment work on it as on a Tuple,
+// and v[i] = row writes through to the columns. A column of bool would be a
+// vector<bool>, which has no bool& to hand out.
+template <typename... Types>
+    requires(sizeof...(Types) > 0) && (!std::is_reference_v<Types> && ...) &&
+            (!std::is_same_v<std::remove_cv_t<Types>, bool> && ...)
+class TupleVector {
+    template <size_t I>
+    using type_at = tuple_detail::type_at<I, Types...>;
+
+    Tuple<std::vector<Types>...> columns_;
+
+    template <typename F, size_t... Is>
+    void for_columns(F&& f, std::index_sequence<Is...>) {
+        (f(get<Is>(columns_)), ...);
+    }
+
+    template <size_t... Is>
+    Tuple<Types&...> row(size_t i, std::index_sequence<Is...>) {
+        return Tuple<Types&...>(get<Is>(columns_)[i]...);
+    }
+
+    template <size_t... Is>
+    Tuple<const Types&...> row(size_t i, std::index_sequence<Is...>) const {
+        return Tuple<const Types&...>(get<Is>(columns_)[i]...);
+    }
+
+    // element I of the new row from every column, the columns stay of one size
+    // when a constructor throws
+    template <typename... Args, size_t... Is>
+    void emplace_row(std::index_sequence<Is...>, Args&&... args) {
+        size_t built = 0;
+        try {
+            ((get<Is>(columns_).emplace_back(std::forward<Args>(args)), ++built), ...);
+        } catch (...) {
+            for_columns(
+                [&built](auto& column) {
+                    if (built > 0) {
+                        column.pop_back();
+                        --built;
+                    }
+                },
+                std::index_sequence_for<Types...>());
+            throw;
+        }
+    }
+
+    template <bool Const>
+    class Iterator {
+        using Owner = std::conditional_t<Const, const TupleVector, TupleVector>;
+
+        Owner* owner_ = nullptr;
+        size_t i_ = 0;
+
+    public:
+        using value_type = Tuple<Types...>;
+        using reference = std::conditional_t<Const, Tuple<const Types&...>, Tuple<Types&...>>;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+
+        Iterator() = default;
+
+        Iterator(Owner* owner, size_t i)
+            : owner_(owner),
+              i_(i) {
+        }
+
+        reference operator*() const {
+            return (*owner_)[i_];
+        }
+
+        Iterator& operator++() {
+            ++i_;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++i_;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return i_ == other.i_;
+        }
+    };
+
+public:
+    using value_type = Tuple<Types...>;
+    using reference = Tuple<Types&...>;
+    using const_reference = Tuple<const Types&...>;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    TupleVector() = default;
+
+    template <typename... Args>
+        requires(sizeof...(Args) == sizeof...(Types)) &&
+                (std::is_constructible_v<Types, Args> && ...)
+    reference emplace_back(Args&&... args) {
+        emplace_row(std::index_sequence_for<Types...>(), std::forward<Args>(args)...);
+        return back();
+    }
+
+    void push_back(const value_type& row) {
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            emplace_row(std::index_sequence<Is...>(), get<Is>(row)...);
+        }(std::index_sequence_for<Types...>());
+    }
+
+    void push_back(value_type&& row) {
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            emplace_row(std::index_sequence<Is...>(), get<Is>(std::move(row))...);
+        }(std::index_sequence_for<Types...>());
+    }
+
+    void pop_back() {
+        for_columns([](auto& column) { column.pop_back(); }, std::index_sequence_for<Types...>());
+    }
+
+    size_t size() const {
+        return get<0>(columns_).size();
+    }
+
+    bool empty() const {
+        return get<0>(columns_).empty();
+    }
+
+    void reserve(size_t count) {
+        for_columns([count](auto& column) { column.reserve(count); },
+                    std::index_sequence_for<Types...>());
+    }
+
+    void clear() {
+        for_columns([](auto& column) { column.clear(); }, std::index_sequence_for<Types...>());
+    }
+
+    reference operator[](size_t i) {
+        return row(i, std::index_sequence_for<Types...>());
+    }
+
+    const_reference operator[](size_t i) const {
+        return row(i, std::index_sequence_for<Types...>());
+    }
+
+    reference back() {
+        return (*this)[size() - 1];
+    }
+
+    const_reference back() const {
+        return (*this)[size() - 1];
+    }
+
+    iterator begin() {
+        return iterator(this, 0);
+    }
+
+    iterator end() {
+        return iterator(this, size());
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, size());
+    }
+
+    // element I of every row, in the order of the rows
+    template <size_t I>
+        requires(I < sizeof...(Types))
+    std::span<type_at<I>> column() {
+        return get<I>(columns_);
+    }
+
+    template <size_t I>
+        requires(I < sizeof...(Types))
+    std::span<const type_at<I>> column() const {
+        return get<I>(columns_);
+    }
+
+    template <typename T>
+        requires tuple_detail::occurs_once<T, Types...>
+    std::span<T> column() {
+        return column<tuple_detail::index_of<T, Types...>()>();
+    }
+
+    template <typename T>
+        requires tuple_detail::occurs_once<T, Types...>
+    std::span<const T> column() const {
+        return column<tuple_detail::index_of<T, Types...>()>();
+    }
+};
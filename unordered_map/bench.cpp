@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "concurrent_unordered_map.h"
+#include "flat_unordered_map.h"
+#include "frozen_map.h"
+#include "rcu_unordered_map.h"
+#include "snapshot.h"
+#include "unordered_map.h"
+#include "util.h"
+
+// Counts the bytes a container keeps allocated, so that memory overhead can be
+// compared next to speed.
+inline size_t allocated_bytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {
+    }
+
+    T* allocate(size_t n) {
+        allocated_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        allocated_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {
+        return true;
+    }
+};
+
+template <typename Body>
+double measure(Body&& body) {
+    Timer timer;
+    body();
+    return std::chrono::duration<double, std::milli>(timer.GetTimes().wall_time).count();
+}
+
+template <template <typename...> typename Map>
+void run(const std::string& name, const std::vector<uint64_t>& keys,
+         const std::vector<uint64_t>& lookups, const std::vector<uint64_t>& misses) {
+    using Alloc = CountingAllocator<std::pair<const uint64_t, uint64_t>>;
+    size_t before = allocated_bytes;
+    Map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, Alloc> map;
+
+    double insert = measure([&] {
+        for (auto key : keys) {
+            map.emplace(key, key);
+        }
+    });
+    size_t memory = allocated_bytes - before;
+
+    uint64_t sum = 0;
+    double hit = measure([&] {
+        for (auto key : lookups) {
+            sum += map.find(key)->second;
+        }
+    });
+    double miss = measure([&] {
+        for (auto key : misses) {
+            sum += map.count(key);
+        }
+    });
+
+    std::cout << name << '\t' << insert << '\t' << hit << '\t' << miss << '\t'
+              << static_cast<double>(memory) / static_cast<double>(keys.size()) << "\t(" << sum
+              << ")\n";
+}
+
+// slowest single insertions, which is where a full rehash shows up
+void run_latency(bool incremental, const std::vector<uint64_t>& keys) {
+    UnorderedMap<uint64_t, uint64_t> map;
+    map.incremental_rehash(incremental);
+    std::vector<double> latencies;
+    latencies.reserve(keys.size());
+    double total = measure([&] {
+        for (auto key : keys) {
+            auto start = std::chrono::steady_clock::now();
+            map.emplace(key, key);
+            latencies.push_back(std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count());
+        }
+    });
+    std::sort(latencies.rbegin(), latencies.rend());
+    std::cout << (incremental ? "incremental" : "full") << '\t' << total << '\t' << latencies[0]
+              << '\t' << latencies[2] << '\t' << latencies[9] << '\n';
+}
+
+// one insert after another against the range constructor, and lookups one by
+// one against find_batch
+void run_bulk(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& lookups) {
+    std::vector<std::pair<uint64_t, uint64_t>> pairs;
+    pairs.reserve(keys.size());
+    for (auto key : keys) {
+        pairs.emplace_back(key, key);
+    }
+    double single = measure([&] {
+        UnorderedMap<uint64_t, uint64_t> map;
+        for (const auto& pair : pairs) {
+            map.insert(pair);
+        }
+    });
+    std::optional<UnorderedMap<uint64_t, uint64_t>> map;
+    double bulk = measure([&] { map.emplace(pairs.begin(), pairs.end()); });
+
+    uint64_t sum = 0;
+    double one_by_one = measure([&] {
+        for (auto key : lookups) {
+            sum += map->find(key)->second;
+        }
+    });
+    // in chunks, so that the found nodes are still in cache when they are read
+    constexpr size_t kChunk = 256;
+    std::vector<UnorderedMap<uint64_t, uint64_t>::iterator> found(kChunk);
+    double batch = measure([&] {
+        for (size_t i = 0; i < lookups.size(); i += kChunk) {
+            std::span chunk(lookups.data() + i, std::min(kChunk, lookups.size() - i));
+            map->find_batch(chunk, found.begin());
+            for (size_t j = 0; j < chunk.size(); ++j) {
+                sum += found[j]->second;
+            }
+        }
+    });
+    std::cout << "\nbuild\tinsert\trange (ms)\n"
+              << "list\t" << single << '\t' << bulk << '\n'
+              << "lookup\tfind\tfind_batch (ms)\n"
+              << "list\t" << one_by_one << '\t' << batch << "\t(" << sum << ")\n";
+}
+
+// what a process start costs: rebuilding the table against mapping a snapshot,
+// each followed by the same lookups
+void run_snapshot(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& lookups) {
+    std::string path = (std::filesystem::temp_directory_path() / "bench_snapshot").string();
+    uint64_t sum = 0;
+    double build = measure([&] {
+        UnorderedMap<uint64_t, uint64_t> map;
+        for (auto key : keys) {
+            map.emplace(key, key);
+        }
+        save_snapshot(map, path);
+    });
+    double rebuild = measure([&] {
+        UnorderedMap<uint64_t, uint64_t> map;
+        for (auto key : keys) {
+            map.emplace(key, key);
+        }
+        for (auto key : lookups) {
+            sum += map.find(key)->second;
+        }
+    });
+    double mapped = measure([&] {
+        UnorderedMapSnapshot<uint64_t, uint64_t> snapshot(path);
+        for (auto key : lookups) {
+            sum += *snapshot.find(key);
+        }
+    });
+    std::filesystem::remove(path);
+    std::cout << "\nstartup\tbuild + save\trebuild + find\tmap + find (ms)\n"
+              << "list\t" << build << '\t' << rebuild << '\t' << mapped << "\t(" << sum
+              << ")\n";
+}
+
+// the mutable map against its frozen copy, built once from the same keys
+void run_frozen(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& lookups,
+                const std::vector<uint64_t>& misses) {
+    UnorderedMap<uint64_t, uint64_t> map;
+    for (auto key : keys) {
+        map.emplace(key, key);
+    }
+    std::optional<FrozenMap<uint64_t, uint64_t>> frozen;
+    double freeze = measure([&] { frozen.emplace(map.freeze()); });
+
+    uint64_t sum = 0;
+    auto lookup = [&](const auto& target) {
+        double hit = measure([&] {
+            for (auto key : lookups) {
+                sum += target.find(key)->second;
+            }
+        });
+        double miss = measure([&] {
+            for (auto key : misses) {
+                sum += target.count(key);
+            }
+        });
+        return std::pair(hit, miss);
+    };
+    auto [list_hit, list_miss] = lookup(map);
+    auto [frozen_hit, frozen_miss] = lookup(*frozen);
+    std::cout << "\nmap\tbuild\thit\tmiss (ms)\n"
+              << "list\t-\t" << list_hit << '\t' << list_miss << '\n'
+              << "frozen\t" << freeze << '\t' << frozen_hit << '\t' << frozen_miss << "\t(" << sum
+              << ")\n";
+}
+
+// Baseline for the sharded map: one UnorderedMap behind one reader-writer lock.
+class LockedMap {
+public:
+    std::optional<uint64_t> find(uint64_t key) const {
+        std::shared_lock lock(mutex_);
+        auto it = map_.find(key);
+        return it == map_.end() ? std::nullopt : std::optional(it->second);
+    }
+
+    void insert_or_assign(uint64_t key, uint64_t value) {
+        std::unique_lock lock(mutex_);
+        map_[key] = value;
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    UnorderedMap<uint64_t, uint64_t> map_;
+};
+
+// every thread does kOps operations, one in ten is a write
+template <typename Map>
+double run_concurrent(Map& map, size_t threads, const std::vector<uint64_t>& keys) {
+    constexpr size_t kOps = 1'000'000;
+    return measure([&] {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&map, &keys, t] {
+                uint64_t sum = 0;
+                size_t index = t * 7919;
+                for (size_t i = 0; i < kOps; ++i) {
+                    index = (index + 104'729) % keys.size();
+                    if (i % 10 == 0) {
+                        map.insert_or_assign(keys[index], i);
+                    } else {
+                        sum += map.find(keys[index]).value_or(0);
+                    }
+                }
+                std::ignore = sum;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    });
+}
+
+void run_scaling(const std::vector<uint64_t>& keys) {
+    LockedMap locked;
+    ConcurrentUnorderedMap<uint64_t, uint64_t> sharded;
+    RcuUnorderedMap<uint64_t, uint64_t> rcu;
+    for (auto key : keys) {
+        locked.insert_or_assign(key, key);
+        sharded.insert_or_assign(key, key);
+        rcu.insert_or_assign(key, key);
+    }
+
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "\nthreads\tone lock\tsharded\trcu (ms, 1M ops per thread, 10% writes)\n";
+    for (size_t threads = 1; threads <= std::max<size_t>(hardware, 4); threads *= 2) {
+        std::cout << threads << '\t' << run_concurrent(locked, threads, keys) << '\t'
+                  << run_concurrent(sharded, threads, keys) << '\t'
+                  << run_concurrent(rcu, threads, keys) << '\n';
+    }
+}
+
+int main() {
+    constexpr size_t kSize = 1'000'000;
+    std::mt19937_64 gen(42);
+
+    std::vector<uint64_t> keys(kSize);
+    for (auto& key : keys) {
+        key = gen() | 1;
+    }
+    // lookups in a different order than insertion, so the cache doesn't help
+    std::vector<uint64_t> lookups = keys;
+    std::shuffle(lookups.begin(), lookups.end(), gen);
+    std::vector<uint64_t> misses(kSize);
+    for (auto& key : misses) {
+        key = gen() & ~uint64_t{1};
+    }
+
+    std::cout << kSize << " uint64 keys\n";
+    std::cout << "map\tinsert\thit\tmiss (ms)\tbytes/element\n";
+    run<std::unordered_map>("std", keys, lookups, misses);
+    run<UnorderedMap>("list", keys, lookups, misses);
+    run<FlatUnorderedMap>("flat", keys, lookups, misses);
+
+    std::cout << "\nrehash\tinsert all\t1st, 3rd and 10th slowest insert (ms)\n";
+    run_latency(false, keys);
+    run_latency(true, keys);
+
+    run_bulk(keys, lookups);
+    run_snapshot(keys, lookups);
+    run_frozen(keys, lookups, misses);
+
+    run_scaling(keys);
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+
+#include "unordered_map.h"
+
+// UnorderedMap split into Shards independently locked submaps. A key always
+// lives in the shard picked by the high bits of its hash (the submap buckets
+// by the low ones), so operations on different shards never contend.
+//
+// Nothing here hands out references or iterators: they would outlive the
+// lock. Readers get a copy (find) or run a callback under the shard lock
+// (visit / modify).
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Value>>, size_t Shards = 64>
+class ConcurrentUnorderedMap {
+    static_assert(std::has_single_bit(Shards), "shard count must be a power of two");
+
+public:
+    using NodeType = std::pair<const Key, Value>;
+    using map_type = UnorderedMap<Key, Value, Hash, Equal, Alloc>;
+
+private:
+    // a cache line of its own, so that locking one shard doesn't bounce its neighbours
+    struct alignas(64) shard {
+        mutable std::shared_mutex mutex;
+        map_type map;
+
+        shard(const Hash& hash, const Equal& equal, const Alloc& alloc)
+            : map(0, hash, equal, alloc) {
+        }
+    };
+
+    std::array<shard, Shards> shards_;
+    [[no_unique_address]] Hash hash_;
+
+    // every shard is built in place from the same functors and allocator,
+    // nothing is default constructed and then assigned
+    template <size_t... Is>
+    static std::array<shard, Shards> make_shards(std::index_sequence<Is...>, const Hash& hash,
+                                                 const Equal& equal, const Alloc& alloc) {
+        return {{((void)Is, shard(hash, equal, alloc))...}};
+    }
+
+    // The key is hashed here to pick the shard and once more by the submap,
+    // which has no lookup by a precomputed hash. The first hash is taken
+    // before locking, so only the second one is paid under the shard lock.
+    shard& shard_for(const Key& key) {
+        return shards_[shard_index(hash_(key))];
+    }
+
+    const shard& shard_for(const Key& key) const {
+        return shards_[shard_index(hash_(key))];
+    }
+
+    static size_t shard_index(size_t hash) {
+        if constexpr (Shards == 1) {
+            return 0;
+        } else {
+            // fibonacci hashing: spreads even poor hashes over the shards
+            constexpr int kShift = 64 - std::countr_zero(Shards);
+            return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >>
+                                       kShift);
+        }
+    }
+
+public:
+    ConcurrentUnorderedMap()
+        : ConcurrentUnorderedMap(Hash()) {
+    }
+
+    explicit ConcurrentUnorderedMap(const Hash& hash, const Equal& equal = Equal(),
+                                    const Alloc& alloc = Alloc())
+        : shards_(make_shards(std::make_index_sequence<Shards>(), hash, equal, alloc)),
+          hash_(hash) {
+    }
+
+    ConcurrentUnorderedMap(const ConcurrentUnorderedMap&) = delete;
+    ConcurrentUnorderedMap& operator=(const ConcurrentUnorderedMap&) = delete;
+
+    std::optional<Value> find(const Key& key) const {
+        const shard& owner = shard_for(key);
+        std::shared_lock lock(owner.mutex);
+        auto it = owner.map.find(key);
+        if (it == owner.map.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    // calls visitor(const Value&) under the shard's shared lock
+    template <typename Visitor>
+    bool visit(const Key& key, Visitor&& visitor) const {
+        const shard& owner = shard_for(key);
+        std::shared_lock lock(owner.mutex);
+        auto it = owner.map.find(key);
+        if (it == owner.map.end()) {
+            return false;
+        }
+        std::forward<Visitor>(visitor)(it->second);
+        return true;
+    }
+
+    // calls modifier(Value&) under the shard's exclusive lock
+    template <typename Modifier>
+    bool modify(const Key& key, Modifier&& modifier) {
+        shard& owner = shard_for(key);
+        std::unique_lock lock(owner.mutex);
+        auto it = owner.map.find(key);
+        if (it == owner.map.end()) {
+            return false;
+        }
+        std::forward<Modifier>(modifier)(it->second);
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        const shard& owner = shard_for(key);
+        std::shared_lock lock(owner.mutex);
+        return owner.map.contains(key);
+    }
+
+    size_t count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    bool insert(const NodeType& node) {
+        shard& owner = shard_for(node.first);
+        std::unique_lock lock(owner.mutex);
+        return owner.map.insert(node).second;
+    }
+
+    bool insert(NodeType&& node) {
+        shard& owner = shard_for(node.first);
+        std::unique_lock lock(owner.mutex);
+        return owner.map.insert(std::move(node)).second;
+    }
+
+    // the node is built before locking, so the shard is held only for the link
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        return insert(NodeType(std::forward<Args>(args)...));
+    }
+
+    template <typename V>
+    bool insert_or_assign(const Key& key, V&& value) {
+        shard& owner = shard_for(key);
+        std::unique_lock lock(owner.mutex);
+        auto it = owner.map.find(key);
+        if (it != owner.map.end()) {
+            it->second = std::forward<V>(value);
+            return false;
+        }
+        owner.map.emplace(key, std::forward<V>(value));
+        return true;
+    }
+
+    size_t erase(const Key& key) {
+        shard& owner = shard_for(key);
+        std::unique_lock lock(owner.mutex);
+        return owner.map.erase(key);
+    }
+
+    // not a snapshot: shards are counted one after another
+    size_t size() const {
+        size_t result = 0;
+        for (const auto& item : shards_) {
+            std::shared_lock lock(item.mutex);
+            result += item.map.size();
+        }
+        return result;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    void clear() {
+        for (auto& item : shards_) {
+            std::unique_lock lock(item.mutex);
+            item.map.clear();
+        }
+    }
+
+    void reserve(size_t count) {
+        for (auto& item : shards_) {
+            std::unique_lock lock(item.mutex);
+            item.map.reserve(count / Shards + 1);
+        }
+    }
+
+    // calls visitor(const NodeType&) for every element, one shard at a time
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) const {
+        for (const auto& item : shards_) {
+            std::shared_lock lock(item.mutex);
+            for (const auto& node : item.map) {
+                visitor(node);
+            }
+        }
+    }
+
+    static constexpr size_t shard_count() {
+        return Shards;
+    }
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Quiescence detection for read-mostly structures in the spirit of userspace
+// RCU. Readers bump a counter of the current epoch parity for as long as they
+// look at shared data. synchronize() flips the parity and waits until nobody
+// is left on the old one: after that no reader can still hold a pointer that
+// was unlinked before the call.
+//
+// Counters are striped over cache lines, so readers on different threads
+// mostly touch different lines. Writers are expected to be serialized by the
+// caller.
+class EpochDomain {
+public:
+    class Guard {
+    public:
+        explicit Guard(const EpochDomain& domain)
+            : domain_(domain),
+              stripe_(thread_stripe()) {
+            while (true) {
+                parity_ = domain_.epoch_.load() & 1;
+                domain_.stripes_[stripe_].readers[parity_].fetch_add(1);
+                // if the epoch moved in between, the writer might have missed us
+                if ((domain_.epoch_.load() & 1) == parity_) {
+                    break;
+                }
+                domain_.stripes_[stripe_].readers[parity_].fetch_sub(1);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard() {
+            domain_.stripes_[stripe_].readers[parity_].fetch_sub(1, std::memory_order_release);
+        }
+
+    private:
+        const EpochDomain& domain_;
+        size_t stripe_;
+        uint64_t parity_ = 0;
+    };
+
+    Guard guard() const {
+        return Guard(*this);
+    }
+
+    // waits until every reader that started before the call is gone
+    void synchronize() {
+        uint64_t old_parity = epoch_.fetch_add(1) & 1;
+        for (const auto& stripe : stripes_) {
+            while (stripe.readers[old_parity].load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kStripes = 32;
+
+    struct alignas(64) stripe {
+        mutable std::atomic<int64_t> readers[2] = {0, 0};
+    };
+
+    static size_t thread_stripe() {
+        static std::atomic<size_t> next = 0;
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % kStripes;
+        return index;
+    }
+
+    std::atomic<uint64_t> epoch_ = 0;
+    std::array<stripe, kStripes> stripes_;
+};
+
+// Deferred reclamation on top of EpochDomain: unlinked objects are collected
+// and freed in batches, one synchronize() per batch.
+class RetireList {
+public:
+    using reclaim_t = void (*)(void* owner, void* ptr);
+
+    explicit RetireList(size_t batch = 256)
+        : batch_(batch) {
+    }
+
+    RetireList(const RetireList&) = delete;
+    RetireList& operator=(const RetireList&) = delete;
+
+    // ptr must already be unreachable for new readers
+    void retire(void* owner, void* ptr, reclaim_t reclaim) {
+        items_.push_back({owner, ptr, reclaim});
+    }
+
+    // frees the batch once it is big enough; call between writes, never while
+    // walking retired memory
+    void collect(EpochDomain& domain) {
+        if (items_.size() >= batch_) {
+            flush(domain);
+        }
+    }
+
+    void flush(EpochDomain& domain) {
+        if (items_.empty()) {
+            return;
+        }
+        domain.synchronize();
+        reclaim_all();
+    }
+
+    // only when no reader can be around, e.g. in a destructor
+    void reclaim_all() {
+        for (const auto& item : items_) {
+            item.reclaim(item.owner, item.ptr);
+        }
+        items_.clear();
+    }
+
+private:
+    struct retired {
+        void* owner;
+        void* ptr;
+        reclaim_t reclaim;
+    };
+
+    std::vector<retired> items_;
+    size_t batch_;
+};
@@ -0,0 +1,793 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Swiss-table style open addressing map. Every slot has a control byte:
+// either a special value (empty / deleted / sentinel) or the low 7 bits of
+// the hash of its key. Lookup checks a whole group of 16 control bytes at
+// once (one SSE2 compare), and compares keys only for slots whose 7-bit tag
+// matched.
+//
+// Unlike UnorderedMap, elements are stored in a flat array and are moved
+// on rehash: pointers and iterators don't survive an insertion that grows
+// the table. Erasure invalidates only the erased element.
+namespace flat_detail {
+
+using ctrl_t = int8_t;
+
+constexpr ctrl_t kEmpty = -128;
+constexpr ctrl_t kDeleted = -2;
+constexpr ctrl_t kSentinel = -1;
+
+constexpr size_t kGroupWidth = 16;
+
+inline bool is_full(ctrl_t c) {
+    return c >= 0;
+}
+
+// bit i is set <=> the i-th control byte of the group matched
+class bitmask {
+public:
+    explicit bitmask(uint32_t mask)
+        : mask_(mask) {
+    }
+
+    explicit operator bool() const {
+        return mask_ != 0;
+    }
+
+    // index of the lowest set bit, which is also the number of zeros below it
+    size_t lowest() const {
+        return static_cast<size_t>(std::countr_zero(mask_));
+    }
+
+    void drop_lowest() {
+        mask_ &= mask_ - 1;
+    }
+
+    size_t leading_zeros() const {
+        return static_cast<size_t>(std::countl_zero(mask_)) - (32 - kGroupWidth);
+    }
+
+private:
+    uint32_t mask_;
+};
+
+class group {
+public:
+    explicit group(const ctrl_t* ctrl) {
+#ifdef __SSE2__
+        ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+        std::memcpy(ctrl_, ctrl, kGroupWidth);
+#endif
+    }
+
+    bitmask match(ctrl_t tag) const {
+#ifdef __SSE2__
+        return movemask(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl_));
+#else
+        return scalar_mask([tag](ctrl_t c) { return c == tag; });
+#endif
+    }
+
+    bitmask match_empty() const {
+        return match(kEmpty);
+    }
+
+    bitmask match_empty_or_deleted() const {
+#ifdef __SSE2__
+        return movemask(_mm_cmpgt_epi8(_mm_set1_epi8(kSentinel), ctrl_));
+#else
+        return scalar_mask([](ctrl_t c) { return c < kSentinel; });
+#endif
+    }
+
+private:
+#ifdef __SSE2__
+    static bitmask movemask(__m128i mask) {
+        return bitmask(static_cast<uint32_t>(_mm_movemask_epi8(mask)));
+    }
+
+    __m128i ctrl_;
+#else
+    template <typename Predicate>
+    bitmask scalar_mask(Predicate predicate) const {
+        uint32_t result = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            result |= static_cast<uint32_t>(predicate(ctrl_[i])) << i;
+        }
+        return bitmask(result);
+    }
+
+    ctrl_t ctrl_[kGroupWidth];
+#endif
+};
+
+// lets the probe loop of an empty table stop immediately
+alignas(kGroupWidth) inline const ctrl_t kEmptyGroup[kGroupWidth] = {
+    kSentinel, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+    kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty};
+
+}  // namespace flat_detail
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Value>>>
+class FlatUnorderedMap {
+public:
+    using NodeType = std::pair<const Key, Value>;
+
+private:
+    using ctrl_t = flat_detail::ctrl_t;
+    using group = flat_detail::group;
+    using bitmask = flat_detail::bitmask;
+
+    static constexpr size_t kGroupWidth = flat_detail::kGroupWidth;
+    // smallest capacity whose cloned tail covers a full group
+    static constexpr size_t kMinCapacity = kGroupWidth - 1;
+
+    using alloc_traits = std::allocator_traits<Alloc>;
+    using slot_alloc_type = typename alloc_traits::template rebind_alloc<NodeType>;
+    using slot_traits = std::allocator_traits<slot_alloc_type>;
+    using ctrl_alloc_type = typename alloc_traits::template rebind_alloc<ctrl_t>;
+    using ctrl_traits = std::allocator_traits<ctrl_alloc_type>;
+
+    // capacity_ is 0 or 2^k - 1. The control array has capacity_ + kGroupWidth
+    // bytes: the slots, the sentinel, and a copy of the first kGroupWidth - 1
+    // bytes so that a group can be loaded at any position without wrapping.
+    ctrl_t* ctrl_ = const_cast<ctrl_t*>(flat_detail::kEmptyGroup);
+    NodeType* slots_ = nullptr;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    size_t growth_left_ = 0;
+    float max_load_factor_ = 0.875f;
+
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] Equal equal_;
+    [[no_unique_address]] slot_alloc_type alloc_;
+
+    template <bool IsConst>
+    class BaseIterator {
+    public:
+        friend class FlatUnorderedMap;
+        template <bool>
+        friend class BaseIterator;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = NodeType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const NodeType*, NodeType*>;
+        using reference = std::conditional_t<IsConst, const NodeType&, NodeType&>;
+
+        BaseIterator() = default;
+
+        BaseIterator(const BaseIterator&) = default;
+
+        BaseIterator& operator=(const BaseIterator&) = default;
+
+        BaseIterator(const BaseIterator<false>& other)
+            requires IsConst
+            : ctrl_(other.ctrl_),
+              slot_(other.slot_) {
+        }
+
+        reference operator*() const {
+            return *slot_;
+        }
+
+        pointer operator->() const {
+            return slot_;
+        }
+
+        BaseIterator& operator++() {
+            ++ctrl_;
+            ++slot_;
+            skip_free();
+            return *this;
+        }
+
+        BaseIterator operator++(int) {
+            BaseIterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const BaseIterator& other) const {
+            return ctrl_ == other.ctrl_;
+        }
+
+    private:
+        const ctrl_t* ctrl_ = nullptr;
+        NodeType* slot_ = nullptr;
+
+        BaseIterator(const ctrl_t* ctrl, NodeType* slot)
+            : ctrl_(ctrl),
+              slot_(slot) {
+        }
+
+        // the sentinel is not full and stops the walk
+        void skip_free() {
+            while (*ctrl_ < flat_detail::kSentinel) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+    };
+
+public:
+    using iterator = BaseIterator<false>;
+    using const_iterator = BaseIterator<true>;
+
+private:
+    static size_t h1(size_t hash) {
+        return hash >> 7;
+    }
+
+    static ctrl_t h2(size_t hash) {
+        return static_cast<ctrl_t>(hash & 0x7F);
+    }
+
+    // std::hash for integers is the identity, so mix before splitting into h1/h2
+    static size_t mix(size_t hash) {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    template <typename K>
+    size_t hash_of(const K& key) const {
+        return mix(hash_(key));
+    }
+
+    size_t growth_limit(size_t capacity) const {
+        return static_cast<size_t>(static_cast<float>(capacity) * max_load_factor_);
+    }
+
+    void set_ctrl(size_t index, ctrl_t value) {
+        ctrl_[index] = value;
+        // keep the cloned tail in sync
+        ctrl_[((index - (kGroupWidth - 1)) & capacity_) + ((kGroupWidth - 1) & capacity_)] = value;
+    }
+
+    // triangular probing over groups visits every group of a 2^k table
+    template <typename Visitor>
+    void probe(size_t hash, Visitor&& visitor) const {
+        size_t offset = h1(hash) & capacity_;
+        for (size_t step = kGroupWidth;; step += kGroupWidth) {
+            if (visitor(offset, group(ctrl_ + offset))) {
+                return;
+            }
+            offset = (offset + step) & capacity_;
+        }
+    }
+
+    template <typename K>
+    size_t find_index(const K& key, size_t hash) const {
+        if (capacity_ == 0) {
+            return capacity_;
+        }
+        size_t result = capacity_;
+        probe(hash, [&](size_t offset, const group& g) {
+            for (bitmask match = g.match(h2(hash)); match; match.drop_lowest()) {
+                size_t index = (offset + match.lowest()) & capacity_;
+                if (equal_(slots_[index].first, key)) {
+                    result = index;
+                    return true;
+                }
+            }
+            return static_cast<bool>(g.match_empty());
+        });
+        return result;
+    }
+
+    size_t find_free(size_t hash) const {
+        size_t result = 0;
+        probe(hash, [&](size_t offset, const group& g) {
+            bitmask free = g.match_empty_or_deleted();
+            if (free) {
+                result = (offset + free.lowest()) & capacity_;
+                return true;
+            }
+            return false;
+        });
+        return result;
+    }
+
+    static size_t normalize_capacity(size_t count) {
+        size_t capacity = kMinCapacity;
+        while (capacity < count) {
+            capacity = capacity * 2 + 1;
+        }
+        return capacity;
+    }
+
+    void deallocate_arrays() {
+        if (capacity_ == 0) {
+            return;
+        }
+        ctrl_alloc_type ctrl_alloc(alloc_);
+        ctrl_traits::deallocate(ctrl_alloc, ctrl_, capacity_ + kGroupWidth);
+        slot_traits::deallocate(alloc_, slots_, capacity_);
+        ctrl_ = const_cast<ctrl_t*>(flat_detail::kEmptyGroup);
+        slots_ = nullptr;
+        capacity_ = 0;
+        growth_left_ = 0;
+    }
+
+    void destroy_all() {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (flat_detail::is_full(ctrl_[i])) {
+                slot_traits::destroy(alloc_, slots_ + i);
+            }
+        }
+        size_ = 0;
+    }
+
+    // moves every element into a fresh table of new_capacity slots
+    void resize(size_t new_capacity) {
+        ctrl_t* old_ctrl = ctrl_;
+        NodeType* old_slots = slots_;
+        size_t old_capacity = capacity_;
+
+        ctrl_alloc_type ctrl_alloc(alloc_);
+        ctrl_t* new_ctrl = ctrl_traits::allocate(ctrl_alloc, new_capacity + kGroupWidth);
+        NodeType* new_slots;
+        try {
+            new_slots = slot_traits::allocate(alloc_, new_capacity);
+        } catch (...) {
+            ctrl_traits::deallocate(ctrl_alloc, new_ctrl, new_capacity + kGroupWidth);
+            throw;
+        }
+        std::fill(new_ctrl, new_ctrl + new_capacity + kGroupWidth, flat_detail::kEmpty);
+        new_ctrl[new_capacity] = flat_detail::kSentinel;
+
+        ctrl_ = new_ctrl;
+        slots_ = new_slots;
+        capacity_ = new_capacity;
+        growth_left_ = growth_limit(new_capacity) - size_;
+
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (!flat_detail::is_full(old_ctrl[i])) {
+                continue;
+            }
+            NodeType& old = old_slots[i];
+            size_t hash = hash_of(old.first);
+            size_t index = find_free(hash);
+            set_ctrl(index, h2(hash));
+            // the key is const only for the users, here the old slot is dying anyway
+            slot_traits::construct(alloc_, slots_ + index, std::move(const_cast<Key&>(old.first)),
+                                   std::move(old.second));
+            slot_traits::destroy(alloc_, &old);
+        }
+
+        if (old_capacity != 0) {
+            ctrl_traits::deallocate(ctrl_alloc, old_ctrl, old_capacity + kGroupWidth);
+            slot_traits::deallocate(alloc_, old_slots, old_capacity);
+        }
+    }
+
+    void grow_if_needed() {
+        if (growth_left_ > 0) {
+            return;
+        }
+        // tombstones count against growth_left_, so a table full of them
+        // is rebuilt at the same size instead of doubling
+        size_t wanted = std::max<size_t>(size_ + 1, 1) * 2;
+        size_t capacity = capacity_ == 0 ? kMinCapacity : normalize_capacity(wanted);
+        while (growth_limit(capacity) <= size_) {
+            capacity = capacity * 2 + 1;
+        }
+        resize(capacity);
+    }
+
+    // index of the key (existing or freshly reserved), whether it is new,
+    // and its hash, so that commit_insert doesn't hash it again
+    struct prepared_insert {
+        size_t index;
+        bool inserted;
+        size_t hash;
+    };
+
+    template <typename K>
+    prepared_insert find_or_prepare_insert(const K& key) {
+        size_t hash = hash_of(key);
+        size_t index = find_index(key, hash);
+        if (index != capacity_) {
+            return {index, false, hash};
+        }
+        grow_if_needed();
+        return {find_free(hash), true, hash};
+    }
+
+    void commit_insert(size_t index, size_t hash) {
+        if (ctrl_[index] == flat_detail::kEmpty) {
+            --growth_left_;
+        }
+        set_ctrl(index, h2(hash));
+        ++size_;
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_impl(K&& key, Args&&... args) {
+        auto [index, inserted, hash] = find_or_prepare_insert(key);
+        if (inserted) {
+            slot_traits::construct(alloc_, slots_ + index, std::piecewise_construct,
+                                   std::forward_as_tuple(std::forward<K>(key)),
+                                   std::forward_as_tuple(std::forward<Args>(args)...));
+            commit_insert(index, hash);
+        }
+        return {iterator_at(index), inserted};
+    }
+
+    iterator iterator_at(size_t index) {
+        return iterator(ctrl_ + index, slots_ + index);
+    }
+
+    const_iterator iterator_at(size_t index) const {
+        return const_iterator(ctrl_ + index, slots_ + index);
+    }
+
+    void erase_at(size_t index) {
+        slot_traits::destroy(alloc_, slots_ + index);
+        --size_;
+        // if no probe sequence could have passed a full group around this
+        // slot, it can become empty again instead of a tombstone
+        size_t before = (index - kGroupWidth) & capacity_;
+        bitmask empty_after = group(ctrl_ + index).match_empty();
+        bitmask empty_before = group(ctrl_ + before).match_empty();
+        bool was_never_full = empty_before && empty_after &&
+                              empty_after.lowest() + empty_before.leading_zeros() < kGroupWidth;
+        set_ctrl(index, was_never_full ? flat_detail::kEmpty : flat_detail::kDeleted);
+        growth_left_ += was_never_full ? 1 : 0;
+    }
+
+    // each element is built once, right in its slot
+    void copy_from(const FlatUnorderedMap& other) {
+        reserve(other.size());
+        for (const auto& node : other) {
+            try_emplace_impl(node.first, node.second);
+        }
+    }
+
+public:
+    FlatUnorderedMap() = default;
+
+    explicit FlatUnorderedMap(size_t bucket_count, const Hash& hash = Hash(),
+                              const Equal& equal = Equal(), const Alloc& alloc = Alloc())
+        : hash_(hash),
+          equal_(equal),
+          alloc_(alloc) {
+        reserve(bucket_count);
+    }
+
+    FlatUnorderedMap(const FlatUnorderedMap& other)
+        : max_load_factor_(other.max_load_factor_),
+          hash_(other.hash_),
+          equal_(other.equal_),
+          alloc_(slot_traits::select_on_container_copy_construction(other.alloc_)) {
+        copy_from(other);
+    }
+
+    FlatUnorderedMap(FlatUnorderedMap&& other) noexcept
+        : ctrl_(std::exchange(other.ctrl_, const_cast<ctrl_t*>(flat_detail::kEmptyGroup))),
+          slots_(std::exchange(other.slots_, nullptr)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          size_(std::exchange(other.size_, 0)),
+          growth_left_(std::exchange(other.growth_left_, 0)),
+          max_load_factor_(other.max_load_factor_),
+          hash_(std::move(other.hash_)),
+          equal_(std::move(other.equal_)),
+          alloc_(std::move(other.alloc_)) {
+    }
+
+    FlatUnorderedMap& operator=(const FlatUnorderedMap& other) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        deallocate_arrays();
+        if constexpr (slot_traits::propagate_on_container_copy_assignment::value) {
+            alloc_ = other.alloc_;
+        }
+        hash_ = other.hash_;
+        equal_ = other.equal_;
+        max_load_factor_ = other.max_load_factor_;
+        copy_from(other);
+        return *this;
+    }
+
+    FlatUnorderedMap& operator=(FlatUnorderedMap&& other) noexcept(
+        slot_traits::propagate_on_container_move_assignment::value ||
+        slot_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        deallocate_arrays();
+        hash_ = std::move(other.hash_);
+        equal_ = std::move(other.equal_);
+        max_load_factor_ = other.max_load_factor_;
+        if constexpr (!slot_traits::propagate_on_container_move_assignment::value &&
+                      !slot_traits::is_always_equal::value) {
+            if (alloc_ != other.alloc_) {
+                // can't steal memory from a foreign allocator, move elementwise
+                reserve(other.size());
+                for (auto& node : other) {
+                    emplace(std::move(const_cast<Key&>(node.first)), std::move(node.second));
+                }
+                other.clear();
+                return *this;
+            }
+        }
+        if constexpr (slot_traits::propagate_on_container_move_assignment::value) {
+            alloc_ = std::move(other.alloc_);
+        }
+        ctrl_ = std::exchange(other.ctrl_, const_cast<ctrl_t*>(flat_detail::kEmptyGroup));
+        slots_ = std::exchange(other.slots_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
+        size_ = std::exchange(other.size_, 0);
+        growth_left_ = std::exchange(other.growth_left_, 0);
+        return *this;
+    }
+
+    ~FlatUnorderedMap() {
+        destroy_all();
+        deallocate_arrays();
+    }
+
+    void swap(FlatUnorderedMap& other) noexcept {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+        std::swap(max_load_factor_, other.max_load_factor_);
+        std::swap(hash_, other.hash_);
+        std::swap(equal_, other.equal_);
+        if constexpr (slot_traits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+    }
+
+    Alloc get_allocator() const {
+        return Alloc(alloc_);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    iterator begin() {
+        iterator it(ctrl_, slots_);
+        it.skip_free();
+        return it;
+    }
+
+    const_iterator begin() const {
+        const_iterator it(ctrl_, slots_);
+        it.skip_free();
+        return it;
+    }
+
+    iterator end() {
+        return iterator(ctrl_ + capacity_, slots_ + capacity_);
+    }
+
+    const_iterator end() const {
+        return const_iterator(ctrl_ + capacity_, slots_ + capacity_);
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+    iterator find(const Key& key) {
+        size_t index = find_index(key, hash_of(key));
+        return index == capacity_ ? end() : iterator_at(index);
+    }
+
+    const_iterator find(const Key& key) const {
+        size_t index = find_index(key, hash_of(key));
+        return index == capacity_ ? end() : iterator_at(index);
+    }
+
+    bool contains(const Key& key) const {
+        return find_index(key, hash_of(key)) != capacity_;
+    }
+
+    size_t count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    Value& at(const Key& key) {
+        size_t index = find_index(key, hash_of(key));
+        if (index == capacity_) {
+            throw std::out_of_range("FlatUnorderedMap::at: no such key");
+        }
+        return slots_[index].second;
+    }
+
+    const Value& at(const Key& key) const {
+        size_t index = find_index(key, hash_of(key));
+        if (index == capacity_) {
+            throw std::out_of_range("FlatUnorderedMap::at: no such key");
+        }
+        return slots_[index].second;
+    }
+
+    Value& operator[](const Key& key) {
+        return try_emplace_impl(key).first->second;
+    }
+
+    Value& operator[](Key&& key) {
+        return try_emplace_impl(std::move(key)).first->second;
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        // the key has to be known before the slot is, so the node is built
+        // aside first and moved into its slot
+        union holder {
+            NodeType node;
+            holder() {
+            }
+            ~holder() {
+            }
+        } tmp;
+        slot_traits::construct(alloc_, &tmp.node, std::forward<Args>(args)...);
+        std::pair<iterator, bool> result;
+        try {
+            auto [index, inserted, hash] = find_or_prepare_insert(tmp.node.first);
+            if (inserted) {
+                slot_traits::construct(alloc_, slots_ + index,
+                                       std::move(const_cast<Key&>(tmp.node.first)),
+                                       std::move(tmp.node.second));
+                commit_insert(index, hash);
+            }
+            result = {iterator_at(index), inserted};
+        } catch (...) {
+            slot_traits::destroy(alloc_, &tmp.node);
+            throw;
+        }
+        slot_traits::destroy(alloc_, &tmp.node);
+        return result;
+    }
+
+    std::pair<iterator, bool> insert(const NodeType& node) {
+        return try_emplace_impl(node.first, node.second);
+    }
+
+    std::pair<iterator, bool> insert(NodeType&& node) {
+        return try_emplace_impl(std::move(const_cast<Key&>(node.first)), std::move(node.second));
+    }
+
+    template <typename P>
+        requires std::is_constructible_v<NodeType, P&&>
+    std::pair<iterator, bool> insert(P&& value) {
+        return emplace(std::forward<P>(value));
+    }
+
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+            reserve(size_ + static_cast<size_t>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            // pairs of Key and Value are built right in their slot, anything
+            // else has to be built aside to learn its key
+            if constexpr (std::is_same_v<std::remove_cvref_t<decltype(*first)>, NodeType> ||
+                          std::is_same_v<std::remove_cvref_t<decltype(*first)>,
+                                         std::pair<Key, Value>>) {
+                auto&& node = *first;
+                try_emplace_impl(std::forward<decltype(node)>(node).first,
+                                 std::forward<decltype(node)>(node).second);
+            } else {
+                emplace(*first);
+            }
+        }
+    }
+
+    iterator erase(const_iterator pos) {
+        size_t index = static_cast<size_t>(pos.slot_ - slots_);
+        erase_at(index);
+        iterator next = iterator_at(index);
+        next.skip_free();
+        return next;
+    }
+
+    iterator erase(iterator pos) {
+        return erase(const_iterator(pos));
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        while (first != last) {
+            first = erase(first);
+        }
+        return iterator_at(static_cast<size_t>(last.slot_ - slots_));
+    }
+
+    size_t erase(const Key& key) {
+        size_t index = find_index(key, hash_of(key));
+        if (index == capacity_) {
+            return 0;
+        }
+        erase_at(index);
+        return 1;
+    }
+
+    void clear() {
+        destroy_all();
+        if (capacity_ != 0) {
+            std::fill(ctrl_, ctrl_ + capacity_ + kGroupWidth, flat_detail::kEmpty);
+            ctrl_[capacity_] = flat_detail::kSentinel;
+            growth_left_ = growth_limit(capacity_);
+        }
+    }
+
+    void reserve(size_t count) {
+        if (count == 0 || growth_limit(capacity_) >= count) {
+            return;
+        }
+        size_t capacity = normalize_capacity(count);
+        while (growth_limit(capacity) < count) {
+            capacity = capacity * 2 + 1;
+        }
+        resize(capacity);
+    }
+
+    size_t bucket_count() const {
+        return capacity_;
+    }
+
+    float load_factor() const {
+        return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / static_cast<float>(capacity_);
+    }
+
+    float max_load_factor() const {
+        return max_load_factor_;
+    }
+
+    // probing needs empty slots to stop, so anything above 7/8 is clamped
+    void max_load_factor(float value) {
+        max_load_factor_ = std::clamp(value, 0.05f, 0.875f);
+        if (capacity_ != 0 && growth_limit(capacity_) < size_) {
+            reserve(size_);
+        } else if (capacity_ != 0) {
+            resize(capacity_);
+        }
+    }
+};
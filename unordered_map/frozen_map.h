@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Immutable map over a fixed set of keys with a minimal perfect hash in the
+// style of CHD (hash, displace and compress). Keys are split into about n / 2
+// small buckets; every bucket gets a seed that sends all of its keys to
+// distinct free slots of an array of exactly n elements. Lookup is one hash,
+// one seed load and one key comparison, and there are no empty slots.
+//
+// Buckets are placed largest first, while the table is still empty and a seed
+// is easy to find. Buckets of one key come last and don't search at all: their
+// seed stores the index of a free slot directly.
+namespace frozen_detail {
+
+// every seed below kDirect is a displacement, kDirect | i means slot i
+constexpr uint32_t kDirect = 1u << 31;
+constexpr uint32_t kMaxSeed = 1u << 20;
+constexpr size_t kAttempts = 8;
+
+// murmur3 finalizer, a bijection on 64 bits
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// maps the upper half of x onto [0, n) without a division
+inline size_t reduce(uint64_t x, size_t n) {
+    return static_cast<size_t>(((x >> 32) * static_cast<uint64_t>(n)) >> 32);
+}
+
+inline size_t slot(uint64_t mixed, uint32_t seed, size_t n) {
+    if (seed & kDirect) {
+        return seed ^ kDirect;
+    }
+    return reduce(mix(mixed + seed * 0x9E3779B97F4A7C15ULL), n);
+}
+
+}  // namespace frozen_detail
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Value>>>
+class FrozenMap {
+public:
+    using NodeType = std::pair<const Key, Value>;
+    using const_iterator = const NodeType*;
+
+private:
+    using alloc_traits = std::allocator_traits<Alloc>;
+    using seed_alloc_type = typename alloc_traits::template rebind_alloc<uint32_t>;
+
+    std::vector<NodeType, Alloc> slots_;
+    std::vector<uint32_t, seed_alloc_type> seeds_;
+    uint64_t salt_ = 0;
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] Equal equal_;
+
+    uint64_t mixed_hash(const Key& key) const {
+        return frozen_detail::mix(static_cast<uint64_t>(hash_(key)) + salt_);
+    }
+
+    size_t bucket_of(uint64_t mixed) const {
+        return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(mixed)) *
+                                    static_cast<uint64_t>(seeds_.size())) >>
+                                   32);
+    }
+
+    // tries to find seeds for every bucket with the current salt; on success
+    // owner[i] is the index of the key that goes to slot i
+    bool place(const std::vector<uint64_t>& hashes, std::vector<size_t>& owner) {
+        size_t n = hashes.size();
+        std::vector<uint64_t> mixed(n);
+        std::vector<size_t> begin(seeds_.size() + 1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            mixed[i] = frozen_detail::mix(hashes[i] + salt_);
+            ++begin[bucket_of(mixed[i]) + 1];
+        }
+        for (size_t b = 0; b < seeds_.size(); ++b) {
+            begin[b + 1] += begin[b];
+        }
+        // keys grouped by bucket
+        std::vector<size_t> keys(n);
+        std::vector<size_t> next(begin.begin(), begin.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            keys[next[bucket_of(mixed[i])]++] = i;
+        }
+        std::vector<size_t> order(seeds_.size());
+        for (size_t b = 0; b < order.size(); ++b) {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(), order.end(), [&begin](size_t lhs, size_t rhs) {
+            return begin[lhs + 1] - begin[lhs] > begin[rhs + 1] - begin[rhs];
+        });
+
+        std::fill(owner.begin(), owner.end(), n);
+        std::fill(seeds_.begin(), seeds_.end(), 0);
+        std::vector<size_t> taken;
+        size_t free_slot = 0;
+        for (size_t b : order) {
+            size_t size = begin[b + 1] - begin[b];
+            if (size == 0) {
+                break;
+            }
+            if (size == 1) {
+                while (owner[free_slot] != n) {
+                    ++free_slot;
+                }
+                owner[free_slot] = keys[begin[b]];
+                seeds_[b] = frozen_detail::kDirect | static_cast<uint32_t>(free_slot);
+                continue;
+            }
+            uint32_t seed = 1;
+            for (; seed < frozen_detail::kMaxSeed; ++seed) {
+                taken.clear();
+                for (size_t i = begin[b]; i < begin[b + 1]; ++i) {
+                    size_t pos = frozen_detail::slot(mixed[keys[i]], seed, n);
+                    if (owner[pos] != n ||
+                        std::find(taken.begin(), taken.end(), pos) != taken.end()) {
+                        break;
+                    }
+                    taken.push_back(pos);
+                }
+                if (taken.size() == size) {
+                    break;
+                }
+            }
+            if (seed == frozen_detail::kMaxSeed) {
+                return false;
+            }
+            for (size_t i = 0; i < size; ++i) {
+                owner[taken[i]] = keys[begin[b] + i];
+            }
+            seeds_[b] = seed;
+        }
+        return true;
+    }
+
+    template <typename ForwardIt>
+    void build(ForwardIt first, ForwardIt last) {
+        std::vector<ForwardIt> nodes;
+        for (; first != last; ++first) {
+            nodes.push_back(first);
+        }
+        size_t n = nodes.size();
+        if (n == 0) {
+            return;
+        }
+        if (n >= frozen_detail::kDirect) {
+            throw std::length_error("FrozenMap: too many keys");
+        }
+        std::vector<uint64_t> hashes(n);
+        for (size_t i = 0; i < n; ++i) {
+            hashes[i] = static_cast<uint64_t>(hash_(nodes[i]->first));
+        }
+        // equal hashes can't be told apart by any seed
+        std::vector<uint64_t> sorted = hashes;
+        std::sort(sorted.begin(), sorted.end());
+        if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            throw std::invalid_argument("FrozenMap: duplicate keys or a full hash collision");
+        }
+
+        seeds_.assign((n + 1) / 2, 0);
+        std::vector<size_t> owner(n);
+        bool placed = false;
+        for (size_t attempt = 0; attempt < frozen_detail::kAttempts && !placed; ++attempt) {
+            salt_ = frozen_detail::mix(attempt + 1);
+            placed = place(hashes, owner);
+        }
+        if (!placed) {
+            throw std::runtime_error("FrozenMap: no perfect hash found");
+        }
+        slots_.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            slots_.emplace_back(*nodes[owner[i]]);
+        }
+    }
+
+public:
+    FrozenMap() = default;
+
+    // keys of the range must be distinct; throws std::invalid_argument if two
+    // of them hash equally
+    template <std::forward_iterator ForwardIt>
+    FrozenMap(ForwardIt first, ForwardIt last, const Hash& hash = Hash(),
+              const Equal& equal = Equal(), const Alloc& alloc = Alloc())
+        : slots_(alloc),
+          seeds_(seed_alloc_type(alloc)),
+          hash_(hash),
+          equal_(equal) {
+        build(first, last);
+    }
+
+    const_iterator find(const Key& key) const {
+        if (slots_.empty()) {
+            return end();
+        }
+        uint64_t mixed = mixed_hash(key);
+        const NodeType& node =
+            slots_[frozen_detail::slot(mixed, seeds_[bucket_of(mixed)], slots_.size())];
+        return equal_(node.first, key) ? &node : end();
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != end();
+    }
+
+    size_t count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    const Value& at(const Key& key) const {
+        const_iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("FrozenMap::at: no such key");
+        }
+        return it->second;
+    }
+
+    size_t size() const {
+        return slots_.size();
+    }
+
+    bool empty() const {
+        return slots_.empty();
+    }
+
+    const_iterator begin() const {
+        return slots_.data();
+    }
+
+    const_iterator end() const {
+        return slots_.data() + slots_.size();
+    }
+
+    Alloc get_allocator() const {
+        return slots_.get_allocator();
+    }
+};
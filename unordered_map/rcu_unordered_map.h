@@ -0,0 +1,483 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "detail/epoch.h"
+
+// Read-mostly hash map whose lookups never lock or write shared memory
+// except an EpochDomain counter. Chains are immutable once published:
+// writers (serialized by a mutex) build new cells and swap them in with one
+// release store, then retire what they replaced. Resize builds a whole new
+// table of cells over the same elements and publishes it the same way.
+//
+// Readers get copies (find) or a callback under the read guard (visit).
+// Don't modify the map from inside a visit callback: writers wait for readers.
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Value>>>
+class RcuUnorderedMap {
+public:
+    using NodeType = std::pair<const Key, Value>;
+
+private:
+    // a chain link; the element may be shared by cells of several tables
+    struct cell {
+        size_t hash;
+        const cell* next;
+        const NodeType* element;
+    };
+
+    struct table {
+        size_t mask;
+        std::atomic<const cell*>* buckets;
+    };
+
+    using alloc_traits = std::allocator_traits<Alloc>;
+    using cell_alloc_type = typename alloc_traits::template rebind_alloc<cell>;
+    using cell_traits = std::allocator_traits<cell_alloc_type>;
+    using table_alloc_type = typename alloc_traits::template rebind_alloc<table>;
+    using table_traits = std::allocator_traits<table_alloc_type>;
+    using bucket_alloc_type = typename alloc_traits::template rebind_alloc<std::atomic<const cell*>>;
+    using bucket_traits = std::allocator_traits<bucket_alloc_type>;
+
+    static constexpr size_t kMinBuckets = 16;
+
+    std::atomic<table*> table_;
+    std::atomic<size_t> size_ = 0;
+    float max_load_factor_ = 1.0f;
+
+    std::mutex writer_mutex_;
+    EpochDomain domain_;
+    RetireList retired_;
+
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] Equal equal_;
+    [[no_unique_address]] Alloc alloc_;
+
+    table* make_table(size_t count) {
+        table_alloc_type table_alloc(alloc_);
+        bucket_alloc_type bucket_alloc(alloc_);
+        table* result = table_traits::allocate(table_alloc, 1);
+        try {
+            auto* buckets = bucket_traits::allocate(bucket_alloc, count);
+            for (size_t i = 0; i < count; ++i) {
+                bucket_traits::construct(bucket_alloc, buckets + i, nullptr);
+            }
+            table_traits::construct(table_alloc, result, table{count - 1, buckets});
+        } catch (...) {
+            table_traits::deallocate(table_alloc, result, 1);
+            throw;
+        }
+        return result;
+    }
+
+    void free_table(table* victim) {
+        table_alloc_type table_alloc(alloc_);
+        bucket_alloc_type bucket_alloc(alloc_);
+        size_t count = victim->mask + 1;
+        for (size_t i = 0; i < count; ++i) {
+            bucket_traits::destroy(bucket_alloc, victim->buckets + i);
+        }
+        bucket_traits::deallocate(bucket_alloc, victim->buckets, count);
+        table_traits::destroy(table_alloc, victim);
+        table_traits::deallocate(table_alloc, victim, 1);
+    }
+
+    const cell* make_cell(size_t hash, const cell* next, const NodeType* element) {
+        cell_alloc_type cell_alloc(alloc_);
+        cell* result = cell_traits::allocate(cell_alloc, 1);
+        cell_traits::construct(cell_alloc, result, cell{hash, next, element});
+        return result;
+    }
+
+    void free_cell(const cell* victim) {
+        cell_alloc_type cell_alloc(alloc_);
+        cell_traits::destroy(cell_alloc, const_cast<cell*>(victim));
+        cell_traits::deallocate(cell_alloc, const_cast<cell*>(victim), 1);
+    }
+
+    template <typename... Args>
+    const NodeType* make_element(Args&&... args) {
+        NodeType* result = alloc_traits::allocate(alloc_, 1);
+        try {
+            alloc_traits::construct(alloc_, result, std::forward<Args>(args)...);
+        } catch (...) {
+            alloc_traits::deallocate(alloc_, result, 1);
+            throw;
+        }
+        return result;
+    }
+
+    void free_element(const NodeType* victim) {
+        alloc_traits::destroy(alloc_, const_cast<NodeType*>(victim));
+        alloc_traits::deallocate(alloc_, const_cast<NodeType*>(victim), 1);
+    }
+
+    // RetireList callbacks
+    static void reclaim_cell(void* owner, void* ptr) {
+        static_cast<RcuUnorderedMap*>(owner)->free_cell(static_cast<const cell*>(ptr));
+    }
+
+    static void reclaim_element(void* owner, void* ptr) {
+        static_cast<RcuUnorderedMap*>(owner)->free_element(static_cast<const NodeType*>(ptr));
+    }
+
+    static void reclaim_table(void* owner, void* ptr) {
+        static_cast<RcuUnorderedMap*>(owner)->free_table(static_cast<table*>(ptr));
+    }
+
+    void retire(const void* ptr, RetireList::reclaim_t reclaim) {
+        retired_.retire(this, const_cast<void*>(ptr), reclaim);
+    }
+
+    const cell* find_cell(const table* current, const Key& key, size_t hash) const {
+        const cell* it = current->buckets[hash & current->mask].load(std::memory_order_acquire);
+        for (; it != nullptr; it = it->next) {
+            if (it->hash == hash && equal_(it->element->first, key)) {
+                return it;
+            }
+        }
+        return nullptr;
+    }
+
+    // frees the unpublished cells from first up to stop
+    void free_chain(const cell* first, const cell* stop) {
+        while (first != stop) {
+            const cell* next = first->next;
+            free_cell(first);
+            first = next;
+        }
+    }
+
+    // Publishes the chain of bucket with target replaced by a cell for
+    // replacement (or just dropped if it is null). Cells in front of target
+    // are copied, the ones behind are shared with the old chain. If a copy
+    // can't be made, the new cells are freed and the old chain stays; the
+    // caller still owns replacement.
+    void replace_cell(table* current, const cell* target, const NodeType* replacement) {
+        auto& bucket = current->buckets[target->hash & current->mask];
+        const cell* head = bucket.load(std::memory_order_relaxed);
+        const cell* tail = replacement == nullptr
+                               ? target->next
+                               : make_cell(target->hash, target->next, replacement);
+        // copy the prefix back to front
+        const cell* prefix[64];
+        size_t prefix_size = 0;
+        const cell* it = head;
+        for (; it != target && prefix_size < std::size(prefix); it = it->next) {
+            prefix[prefix_size++] = it;
+        }
+        try {
+            if (it != target) {
+                // pathological chain, fall back to a recursive copy
+                tail = copy_prefix(it, target, tail);
+            }
+            for (size_t i = prefix_size; i > 0; --i) {
+                tail = make_cell(prefix[i - 1]->hash, tail, prefix[i - 1]->element);
+            }
+        } catch (...) {
+            free_chain(tail, target->next);
+            throw;
+        }
+        bucket.store(tail, std::memory_order_release);
+
+        for (it = head; it != target; it = it->next) {
+            retire(it, reclaim_cell);
+        }
+        retire(target, reclaim_cell);
+    }
+
+    // on failure frees what it has built, tail stays with the caller
+    const cell* copy_prefix(const cell* from, const cell* target, const cell* tail) {
+        if (from == target) {
+            return tail;
+        }
+        const cell* rest = copy_prefix(from->next, target, tail);
+        try {
+            return make_cell(from->hash, rest, from->element);
+        } catch (...) {
+            free_chain(rest, tail);
+            throw;
+        }
+    }
+
+    void grow_if_needed(table* current) {
+        size_t count = current->mask + 1;
+        if (static_cast<float>(size()) <= static_cast<float>(count) * max_load_factor_) {
+            return;
+        }
+        rehash_to(count * 2);
+    }
+
+    // frees the cells of a table nobody has seen, elements stay
+    void discard_table(table* victim) {
+        for (size_t i = 0; i <= victim->mask; ++i) {
+            const cell* it = victim->buckets[i].load(std::memory_order_relaxed);
+            while (it != nullptr) {
+                const cell* next = it->next;
+                free_cell(it);
+                it = next;
+            }
+        }
+        free_table(victim);
+    }
+
+    void rehash_to(size_t count) {
+        table* current = table_.load(std::memory_order_relaxed);
+        table* fresh = make_table(count);
+        try {
+            for (size_t i = 0; i <= current->mask; ++i) {
+                for (const cell* it = current->buckets[i].load(std::memory_order_relaxed);
+                     it != nullptr; it = it->next) {
+                    auto& bucket = fresh->buckets[it->hash & fresh->mask];
+                    bucket.store(make_cell(it->hash, bucket.load(std::memory_order_relaxed),
+                                           it->element),
+                                 std::memory_order_relaxed);
+                }
+            }
+        } catch (...) {
+            discard_table(fresh);
+            throw;
+        }
+        table_.store(fresh, std::memory_order_release);
+
+        for (size_t i = 0; i <= current->mask; ++i) {
+            for (const cell* it = current->buckets[i].load(std::memory_order_relaxed);
+                 it != nullptr; it = it->next) {
+                retire(it, reclaim_cell);
+            }
+        }
+        retire(current, reclaim_table);
+    }
+
+    // takes ownership of element; returns false (and frees it) if the key exists
+    bool insert_element(const NodeType* element) {
+        size_t hash;
+        try {
+            hash = hash_(element->first);
+        } catch (...) {
+            free_element(element);
+            throw;
+        }
+        std::lock_guard lock(writer_mutex_);
+        table* current = table_.load(std::memory_order_relaxed);
+        const cell* found;
+        try {
+            found = find_cell(current, element->first, hash);
+        } catch (...) {
+            free_element(element);
+            throw;
+        }
+        if (found != nullptr) {
+            free_element(element);
+            return false;
+        }
+        link_element(current, hash, element);
+        retired_.collect(domain_);
+        return true;
+    }
+
+    // prepends a cell for a new element, which is freed if that fails
+    void link_element(table* current, size_t hash, const NodeType* element) {
+        auto& bucket = current->buckets[hash & current->mask];
+        const cell* head;
+        try {
+            head = make_cell(hash, bucket.load(std::memory_order_relaxed), element);
+        } catch (...) {
+            free_element(element);
+            throw;
+        }
+        bucket.store(head, std::memory_order_release);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        // The element is published, so the insert has happened whatever the
+        // resize does. A failed resize leaves the old, still valid, table in
+        // place, and the next insert tries again.
+        try {
+            grow_if_needed(current);
+        } catch (...) {
+        }
+    }
+
+    void free_all() {
+        retired_.reclaim_all();
+        table* current = table_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i <= current->mask; ++i) {
+            const cell* it = current->buckets[i].load(std::memory_order_relaxed);
+            while (it != nullptr) {
+                const cell* next = it->next;
+                free_element(it->element);
+                free_cell(it);
+                it = next;
+            }
+        }
+        free_table(current);
+    }
+
+public:
+    RcuUnorderedMap()
+        : RcuUnorderedMap(kMinBuckets) {
+    }
+
+    explicit RcuUnorderedMap(size_t bucket_count, const Hash& hash = Hash(),
+                             const Equal& equal = Equal(), const Alloc& alloc = Alloc())
+        : hash_(hash),
+          equal_(equal),
+          alloc_(alloc) {
+        size_t count = kMinBuckets;
+        while (count < bucket_count) {
+            count *= 2;
+        }
+        table_.store(make_table(count), std::memory_order_relaxed);
+    }
+
+    RcuUnorderedMap(const RcuUnorderedMap&) = delete;
+    RcuUnorderedMap& operator=(const RcuUnorderedMap&) = delete;
+
+    ~RcuUnorderedMap() {
+        free_all();
+    }
+
+    // lock-free
+    std::optional<Value> find(const Key& key) const {
+        size_t hash = hash_(key);
+        auto guard = domain_.guard();
+        const cell* found = find_cell(table_.load(std::memory_order_acquire), key, hash);
+        if (found == nullptr) {
+            return std::nullopt;
+        }
+        return found->element->second;
+    }
+
+    // lock-free; calls visitor(const Value&) while the element is guaranteed alive
+    template <typename Visitor>
+    bool visit(const Key& key, Visitor&& visitor) const {
+        size_t hash = hash_(key);
+        auto guard = domain_.guard();
+        const cell* found = find_cell(table_.load(std::memory_order_acquire), key, hash);
+        if (found == nullptr) {
+            return false;
+        }
+        std::forward<Visitor>(visitor)(found->element->second);
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        size_t hash = hash_(key);
+        auto guard = domain_.guard();
+        return find_cell(table_.load(std::memory_order_acquire), key, hash) != nullptr;
+    }
+
+    size_t count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    // calls visitor(const NodeType&) for every element of one table version
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) const {
+        auto guard = domain_.guard();
+        const table* current = table_.load(std::memory_order_acquire);
+        for (size_t i = 0; i <= current->mask; ++i) {
+            for (const cell* it = current->buckets[i].load(std::memory_order_acquire);
+                 it != nullptr; it = it->next) {
+                visitor(*it->element);
+            }
+        }
+    }
+
+    bool insert(const NodeType& node) {
+        return insert_element(make_element(node));
+    }
+
+    bool insert(NodeType&& node) {
+        return insert_element(make_element(std::move(node)));
+    }
+
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        return insert_element(make_element(std::forward<Args>(args)...));
+    }
+
+    // an existing element is replaced by a new one, never changed in place
+    template <typename V>
+    bool insert_or_assign(const Key& key, V&& value) {
+        size_t hash = hash_(key);
+        const NodeType* element = make_element(key, std::forward<V>(value));
+        std::lock_guard lock(writer_mutex_);
+        table* current = table_.load(std::memory_order_relaxed);
+        const cell* found;
+        try {
+            found = find_cell(current, key, hash);
+        } catch (...) {
+            free_element(element);
+            throw;
+        }
+        if (found == nullptr) {
+            link_element(current, hash, element);
+            retired_.collect(domain_);
+            return true;
+        }
+        const NodeType* old = found->element;
+        try {
+            replace_cell(current, found, element);
+        } catch (...) {
+            free_element(element);
+            throw;
+        }
+        retire(old, reclaim_element);
+        retired_.collect(domain_);
+        return false;
+    }
+
+    size_t erase(const Key& key) {
+        size_t hash = hash_(key);
+        std::lock_guard lock(writer_mutex_);
+        table* current = table_.load(std::memory_order_relaxed);
+        const cell* found = find_cell(current, key, hash);
+        if (found == nullptr) {
+            return 0;
+        }
+        const NodeType* old = found->element;
+        replace_cell(current, found, nullptr);
+        retire(old, reclaim_element);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        retired_.collect(domain_);
+        return 1;
+    }
+
+    // frees everything retired so far; waits for readers that may still see it
+    void reclaim() {
+        std::lock_guard lock(writer_mutex_);
+        retired_.flush(domain_);
+    }
+
+    void reserve(size_t count) {
+        std::lock_guard lock(writer_mutex_);
+        size_t buckets = table_.load(std::memory_order_relaxed)->mask + 1;
+        size_t needed = buckets;
+        while (static_cast<float>(count) > static_cast<float>(needed) * max_load_factor_) {
+            needed *= 2;
+        }
+        if (needed != buckets) {
+            rehash_to(needed);
+            retired_.collect(domain_);
+        }
+    }
+
+    size_t size() const {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t bucket_count() const {
+        return table_.load(std::memory_order_acquire)->mask + 1;
+    }
+};
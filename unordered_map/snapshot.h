@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "unordered_map.h"
+
+// Read-only image of an UnorderedMap with trivially copyable keys and values,
+// laid out so that it can be mmap'd and queried in place:
+//
+//   header | bucket offsets (bucket_count + 1) | entries {hash, key, value}
+//
+// Entries of one bucket are contiguous, bucket b owns the entries
+// [offsets[b], offsets[b + 1]). Only offsets are stored, never pointers, so
+// the file works at any address and the pages are shared between processes
+// that map it. The format is native: same byte order and type layout on both
+// ends, and Hash must give the same values in the reading process (std::hash
+// of integers does, std::hash of strings is not promised to).
+namespace snapshot_detail {
+
+constexpr char kMagic[8] = {'U', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrder = 0x01020304;
+
+struct header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t key_size;
+    uint32_t value_size;
+    uint32_t entry_size;
+    uint32_t entry_align;
+    uint64_t size;
+    uint64_t bucket_count;
+    uint64_t offsets_at;
+    uint64_t entries_at;
+};
+
+template <typename Key, typename Value>
+struct entry {
+    uint64_t hash;
+    Key key;
+    Value value;
+};
+
+constexpr uint64_t align_up(uint64_t offset, uint64_t align) {
+    return (offset + align - 1) / align * align;
+}
+
+// A new file next to the target, renamed over it once it is complete. The
+// old file is never truncated, so processes that have it mapped keep reading
+// the old snapshot instead of getting SIGBUS, and a failed save leaves it as
+// it was.
+class temp_file {
+public:
+    explicit temp_file(const std::string& target)
+        : path_(target + ".XXXXXX") {
+        fd_ = ::mkstemp(path_.data());
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "can't create " + path_);
+        }
+        // mkstemp gives 0600, the snapshot is meant to be mapped by others too
+        if (::fchmod(fd_, 0644) != 0) {
+            int error = errno;
+            ::close(fd_);
+            ::unlink(path_.c_str());
+            throw std::system_error(error, std::generic_category(), "can't chmod " + path_);
+        }
+    }
+
+    temp_file(const temp_file&) = delete;
+    temp_file& operator=(const temp_file&) = delete;
+
+    ~temp_file() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            ::unlink(path_.c_str());
+        }
+    }
+
+    void write(const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t written = ::write(fd_, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fail("can't write ");
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    // the data reaches the disk before the name does, so the target is
+    // either the old snapshot or the whole new one
+    void replace(const std::string& target) {
+        if (::fsync(fd_) != 0) {
+            fail("can't sync ");
+        }
+        int fd = std::exchange(fd_, -1);
+        if (::close(fd) != 0 || ::rename(path_.c_str(), target.c_str()) != 0) {
+            int error = errno;
+            ::unlink(path_.c_str());
+            throw std::system_error(error, std::generic_category(), "can't replace " + target);
+        }
+    }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+
+    [[noreturn]] void fail(const char* what) {
+        int error = errno;
+        throw std::system_error(error, std::generic_category(), what + path_);
+    }
+};
+
+}  // namespace snapshot_detail
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void save_snapshot(const UnorderedMap<Key, Value, Hash, Equal, Alloc>& map,
+                   const std::string& path) {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "only trivially copyable keys and values can be stored as is");
+    using entry = snapshot_detail::entry<Key, Value>;
+    static_assert(std::is_standard_layout_v<entry>,
+                  "entries are written member by member at their offsetof");
+
+    uint64_t bucket_count = 1;
+    while (bucket_count < map.size()) {
+        bucket_count *= 2;
+    }
+    uint64_t mask = bucket_count - 1;
+
+    // counting sort by bucket
+    Hash hash = map.hash_function();
+    std::vector<uint64_t> hashes;
+    hashes.reserve(map.size());
+    std::vector<uint64_t> offsets(bucket_count + 1, 0);
+    for (const auto& node : map) {
+        hashes.push_back(static_cast<uint64_t>(hash(node.first)));
+        ++offsets[(hashes.back() & mask) + 1];
+    }
+    for (uint64_t i = 0; i < bucket_count; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    // built as bytes: Key and Value need neither a default constructor nor an
+    // assignment, and the padding between the members is written as zeros
+    std::vector<unsigned char> entries(map.size() * sizeof(entry), 0);
+    std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+    size_t index = 0;
+    for (const auto& node : map) {
+        unsigned char* item = entries.data() + next[hashes[index] & mask]++ * sizeof(entry);
+        std::memcpy(item + offsetof(entry, hash), &hashes[index++], sizeof(uint64_t));
+        std::memcpy(item + offsetof(entry, key), std::addressof(node.first), sizeof(Key));
+        std::memcpy(item + offsetof(entry, value), std::addressof(node.second), sizeof(Value));
+    }
+
+    snapshot_detail::header head{};
+    std::memcpy(head.magic, snapshot_detail::kMagic, sizeof(head.magic));
+    head.version = snapshot_detail::kVersion;
+    head.byte_order = snapshot_detail::kByteOrder;
+    head.key_size = sizeof(Key);
+    head.value_size = sizeof(Value);
+    head.entry_size = sizeof(entry);
+    head.entry_align = alignof(entry);
+    head.size = map.size();
+    head.bucket_count = bucket_count;
+    head.offsets_at = sizeof(head);
+    head.entries_at = snapshot_detail::align_up(
+        head.offsets_at + offsets.size() * sizeof(uint64_t), alignof(entry));
+
+    const char zeros[alignof(entry)] = {};
+    snapshot_detail::temp_file out(path);
+    out.write(&head, sizeof(head));
+    out.write(offsets.data(), offsets.size() * sizeof(uint64_t));
+    out.write(zeros, head.entries_at - head.offsets_at - offsets.size() * sizeof(uint64_t));
+    out.write(entries.data(), entries.size());
+    out.replace(path);
+}
+
+// A snapshot file mapped into memory. Opening it costs one mmap: nothing is
+// read or copied until a lookup touches the page it needs.
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class UnorderedMapSnapshot {
+public:
+    using entry = snapshot_detail::entry<Key, Value>;
+
+    explicit UnorderedMapSnapshot(const std::string& path, const Hash& hash = Hash(),
+                                  const Equal& equal = Equal())
+        : hash_(hash),
+          equal_(equal) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "can't open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "can't stat " + path);
+        }
+        length_ = static_cast<size_t>(info.st_size);
+        void* data = length_ == 0 ? MAP_FAILED
+                                  : ::mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+        int error = errno;
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::system_error(length_ == 0 ? EINVAL : error, std::generic_category(),
+                                    "can't map " + path);
+        }
+        data_ = static_cast<const unsigned char*>(data);
+        try {
+            attach();
+        } catch (...) {
+            ::munmap(const_cast<unsigned char*>(data_), length_);
+            throw;
+        }
+    }
+
+    UnorderedMapSnapshot(UnorderedMapSnapshot&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          length_(std::exchange(other.length_, 0)),
+          offsets_(other.offsets_),
+          entries_(other.entries_),
+          size_(other.size_),
+          mask_(other.mask_),
+          hash_(std::move(other.hash_)),
+          equal_(std::move(other.equal_)) {
+    }
+
+    UnorderedMapSnapshot& operator=(UnorderedMapSnapshot&& other) noexcept {
+        UnorderedMapSnapshot copy(std::move(other));
+        std::swap(data_, copy.data_);
+        std::swap(length_, copy.length_);
+        std::swap(offsets_, copy.offsets_);
+        std::swap(entries_, copy.entries_);
+        std::swap(size_, copy.size_);
+        std::swap(mask_, copy.mask_);
+        std::swap(hash_, copy.hash_);
+        std::swap(equal_, copy.equal_);
+        return *this;
+    }
+
+    ~UnorderedMapSnapshot() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<unsigned char*>(data_), length_);
+        }
+    }
+
+    // nullptr if there is no such key
+    const Value* find(const Key& key) const {
+        uint64_t hash = static_cast<uint64_t>(hash_(key));
+        uint64_t index = hash & mask_;
+        uint64_t last = std::min<uint64_t>(offsets_[index + 1], size_);
+        for (uint64_t i = offsets_[index]; i < last; ++i) {
+            if (entries_[i].hash == hash && equal_(entries_[i].key, key)) {
+                return &entries_[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    size_t count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    const Value& at(const Key& key) const {
+        const Value* value = find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("UnorderedMapSnapshot::at: no such key");
+        }
+        return *value;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    size_t bucket_count() const {
+        return mask_ + 1;
+    }
+
+    // entries in bucket order
+    const entry* begin() const {
+        return entries_;
+    }
+
+    const entry* end() const {
+        return entries_ + size_;
+    }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t length_ = 0;
+    const uint64_t* offsets_ = nullptr;
+    const entry* entries_ = nullptr;
+    size_t size_ = 0;
+    uint64_t mask_ = 0;
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] Equal equal_;
+
+    // checks that the file is a snapshot of this very Key and Value and that
+    // its sections fit; bucket offsets are only clamped when a lookup reads
+    // them, so that opening doesn't page the whole index in
+    void attach() {
+        snapshot_detail::header head;
+        if (length_ < sizeof(head)) {
+            throw std::runtime_error("UnorderedMapSnapshot: file is too short");
+        }
+        std::memcpy(&head, data_, sizeof(head));
+        if (std::memcmp(head.magic, snapshot_detail::kMagic, sizeof(head.magic)) != 0 ||
+            head.version != snapshot_detail::kVersion ||
+            head.byte_order != snapshot_detail::kByteOrder) {
+            throw std::runtime_error("UnorderedMapSnapshot: not a snapshot");
+        }
+        if (head.key_size != sizeof(Key) || head.value_size != sizeof(Value) ||
+            head.entry_size != sizeof(entry) || head.entry_align != alignof(entry)) {
+            throw std::runtime_error("UnorderedMapSnapshot: written for other types");
+        }
+        uint64_t bucket_count = head.bucket_count;
+        if (bucket_count == 0 || (bucket_count & (bucket_count - 1)) != 0 ||
+            head.offsets_at != sizeof(head) ||
+            bucket_count + 1 > (length_ - sizeof(head)) / sizeof(uint64_t) ||
+            head.entries_at % alignof(entry) != 0 ||
+            head.entries_at < head.offsets_at + (bucket_count + 1) * sizeof(uint64_t) ||
+            head.entries_at > length_ || head.size > (length_ - head.entries_at) / sizeof(entry)) {
+            throw std::runtime_error("UnorderedMapSnapshot: corrupted layout");
+        }
+        offsets_ = reinterpret_cast<const uint64_t*>(data_ + head.offsets_at);
+        if (offsets_[0] != 0 || offsets_[bucket_count] != head.size) {
+            throw std::runtime_error("UnorderedMapSnapshot: corrupted layout");
+        }
+        entries_ = reinterpret_cast<const entry*>(data_ + head.entries_at);
+        size_ = head.size;
+        mask_ = bucket_count - 1;
+    }
+};
@@ -1,14 +1,30 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
 #include <functional>
 #include <iterator>
+#include <new>
 #include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
 #include <ranges>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+#include "concurrent_unordered_map.h"
+#include "flat_unordered_map.h"
+#include "frozen_map.h"
+#include "rcu_unordered_map.h"
+#include "snapshot.h"
 #include "unordered_map.h"
 
 // template <typename Key, typename Value, typename Hash = std::hash<Key>,
@@ -782,4 +798,790 @@ TEST_CASE("Misc") {
     }
 }
 
-};  // namespace Additional
\ No newline at end of file
+};  // namespace Additional
+
+namespace CachedHash {
+
+inline size_t hash_calls = 0;
+inline size_t equal_calls = 0;
+
+struct CountingHash {
+    size_t operator()(int x) const {
+        ++hash_calls;
+        return static_cast<size_t>(x);
+    }
+};
+
+struct CountingEqual {
+    bool operator()(int x, int y) const {
+        ++equal_calls;
+        return x == y;
+    }
+};
+
+TEST_CASE("Cached hash") {
+    UnorderedMap<int, int, CountingHash, CountingEqual> map;
+    for (int i = 0; i < 1000; ++i) {
+        map.emplace(i, i);
+    }
+    REQUIRE(hash_calls == 1000);
+    REQUIRE(equal_calls == 0);
+
+    map.reserve(100'000);
+    REQUIRE(hash_calls == 1000);
+
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(map.at(i) == i);
+    }
+    REQUIRE(equal_calls == 1000);
+
+    size_t steps = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        ++steps;
+    }
+    REQUIRE(steps == map.size());
+}
+
+TEST_CASE("Incremental rehash") {
+    UnorderedMap<int, std::string> map;
+    map.incremental_rehash(true);
+    std::unordered_map<int, std::string> expected;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> key(0, 20'000);
+
+    auto check_all = [&](const auto& checked) {
+        REQUIRE(checked.size() == expected.size());
+        REQUIRE(static_cast<size_t>(std::distance(checked.begin(), checked.end())) ==
+                expected.size());
+        for (const auto& [k, v] : checked) {
+            REQUIRE(expected.at(k) == v);
+        }
+    };
+
+    for (int i = 0; i < 100'000; ++i) {
+        int k = key(gen);
+        switch (gen() % 5) {
+            case 0:
+            case 1:
+                REQUIRE(map.emplace(k, std::to_string(i)).second ==
+                        expected.emplace(k, std::to_string(i)).second);
+                break;
+            case 2:
+                map[k] = std::to_string(k);
+                expected[k] = std::to_string(k);
+                break;
+            case 3:
+                REQUIRE(map.erase(k) == expected.erase(k));
+                break;
+            default:
+                REQUIRE((map.find(k) == map.end()) == !expected.contains(k));
+        }
+        if (i % 10'000 == 0) {
+            check_all(map);
+            auto copy = map;
+            check_all(copy);
+        }
+    }
+    check_all(map);
+
+    auto moved = std::move(map);
+    check_all(moved);
+    moved.incremental_rehash(false);
+    check_all(moved);
+    for (auto it = moved.begin(); it != moved.end();) {
+        it = it->first % 3 == 0 ? moved.erase(it) : std::next(it);
+    }
+    std::erase_if(expected, [](const auto& item) { return item.first % 3 == 0; });
+    check_all(moved);
+}
+
+}  // namespace CachedHash
+
+struct Name {
+    static inline size_t constructed = 0;
+
+    std::string value;
+
+    Name(std::string_view name)
+        : value(name) {
+        ++constructed;
+    }
+
+    bool operator==(const Name&) const = default;
+};
+
+struct NameHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view name) const {
+        return std::hash<std::string_view>()(name);
+    }
+
+    size_t operator()(const Name& name) const {
+        return (*this)(std::string_view(name.value));
+    }
+};
+
+struct NameEqual {
+    using is_transparent = void;
+
+    static std::string_view view(std::string_view name) {
+        return name;
+    }
+
+    static std::string_view view(const Name& name) {
+        return name.value;
+    }
+
+    bool operator()(const auto& left, const auto& right) const {
+        return view(left) == view(right);
+    }
+};
+
+TEST_CASE("Transparent lookup") {
+    UnorderedMap<Name, int, NameHash, NameEqual> map;
+    map.emplace(Name("alpha"), 1);
+    map.emplace(Name("beta"), 2);
+    size_t before = Name::constructed;
+
+    std::string_view alpha = "alpha";
+    REQUIRE(map.find(alpha)->second == 1);
+    REQUIRE(map.find(std::string_view("gamma")) == map.end());
+    REQUIRE(map.contains(std::string_view("beta")));
+    REQUIRE(map.count(alpha) == 1);
+    REQUIRE(map.at(std::string_view("beta")) == 2);
+    REQUIRE_THROWS_AS(map.at(std::string_view("gamma")), std::out_of_range);
+    const auto& const_map = map;
+    REQUIRE(const_map.find(alpha)->second == 1);
+    REQUIRE(map.erase(alpha) == 1);
+    REQUIRE(map.erase(alpha) == 0);
+    REQUIRE(Name::constructed == before);
+    REQUIRE(map.size() == 1);
+
+    // without is_transparent the argument is converted to Key first
+    UnorderedMap<Name, int, NameHash> plain;
+    plain.emplace(Name("alpha"), 1);
+    before = Name::constructed;
+    REQUIRE(plain.contains(alpha));
+    REQUIRE(Name::constructed == before + 1);
+}
+
+inline size_t node_allocations = 0;
+
+template <typename T>
+struct AllocationCounter : std::allocator<T> {
+    AllocationCounter() = default;
+
+    template <typename U>
+    AllocationCounter(const AllocationCounter<U>&) {
+    }
+
+    T* allocate(size_t n) {
+        ++node_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    template <typename U>
+    struct rebind {
+        using other = AllocationCounter<U>;
+    };
+};
+
+TEST_CASE("Extract and merge") {
+    using Map = UnorderedMap<std::string, std::string, std::hash<std::string>,
+                             std::equal_to<std::string>,
+                             AllocationCounter<std::pair<const std::string, std::string>>>;
+    Map first;
+    Map second;
+    for (int i = 0; i < 100; ++i) {
+        first.emplace(std::to_string(i), "first");
+        if (i % 2 == 0) {
+            second.emplace(std::to_string(i), "second");
+        }
+    }
+    second.reserve(200);
+    const std::string* address = &first.find("1")->second;
+    size_t before = node_allocations;
+
+    auto node = first.extract("1");
+    REQUIRE(node);
+    REQUIRE(node.key() == "1");
+    REQUIRE(first.size() == 99);
+    REQUIRE_FALSE(first.contains("1"));
+    REQUIRE(first.extract("1").empty());
+
+    node.key() = "one";
+    auto result = second.insert(std::move(node));
+    REQUIRE(result.inserted);
+    REQUIRE(result.node.empty());
+    REQUIRE(&result.position->second == address);
+    REQUIRE(second.at("one") == "first");
+
+    auto duplicate = second.insert(first.extract(first.find("2")));
+    REQUIRE_FALSE(duplicate.inserted);
+    REQUIRE(duplicate.node.key() == "2");
+    REQUIRE(duplicate.position->second == "second");
+
+    second.merge(first);
+    REQUIRE(node_allocations == before);
+    REQUIRE(first.size() == 49);
+    REQUIRE(second.size() == 100);
+    for (const auto& [key, value] : first) {
+        REQUIRE(std::stoi(key) % 2 == 0);
+        REQUIRE(second.at(key) == "second");
+    }
+    for (int i = 3; i < 100; i += 2) {
+        REQUIRE(second.at(std::to_string(i)) == "first");
+    }
+}
+
+// counts the live copies, a double destruction drives it below zero
+struct Alive {
+    inline static int count = 0;
+
+    Alive() {
+        ++count;
+    }
+    Alive(const Alive&) {
+        ++count;
+    }
+    ~Alive() {
+        --count;
+    }
+};
+
+struct SameHash {
+    size_t operator()(int) const {
+        return 0;
+    }
+};
+
+// throws on the third comparison, when some nodes are already linked
+struct ThirdCallThrows {
+    inline static int calls = 0;
+
+    bool operator()(int lhs, int rhs) const {
+        if (++calls == 3) {
+            throw std::runtime_error("equal");
+        }
+        return lhs == rhs;
+    }
+};
+
+TEST_CASE("Bulk build and batched lookup") {
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 10000; ++i) {
+        pairs.emplace_back(i % 7000, i);
+    }
+    UnorderedMap<int, int> map(pairs.begin(), pairs.end());
+    REQUIRE(map.size() == 7000);
+    // the first of equal keys wins
+    REQUIRE(map.at(10) == 10);
+    REQUIRE(map.load_factor() <= map.max_load_factor());
+    size_t buckets = map.bucket_count();
+
+    map.insert(pairs.begin(), pairs.begin() + 100);
+    REQUIRE(map.size() == 7000);
+    REQUIRE(map.bucket_count() == buckets);
+
+    std::vector<int> keys;
+    for (int i = -500; i < 7500; i += 3) {
+        keys.push_back(i);
+    }
+    std::vector<UnorderedMap<int, int>::iterator> found;
+    map.find_batch(keys, std::back_inserter(found));
+    REQUIRE(found.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        REQUIRE(found[i] == map.find(keys[i]));
+    }
+
+    // lookups have to see both tables while an incremental rehash is going on
+    UnorderedMap<int, int> growing;
+    growing.incremental_rehash(true);
+    for (int i = 0; i < 5000; ++i) {
+        growing.emplace(i, i);
+    }
+    const auto& view = growing;
+    std::vector<UnorderedMap<int, int>::const_iterator> results(keys.size());
+    view.find_batch(keys, results.begin());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        REQUIRE(results[i] == view.find(keys[i]));
+    }
+
+    UnorderedMap<int, int> empty;
+    found.clear();
+    empty.find_batch(keys, std::back_inserter(found));
+    REQUIRE(std::ranges::all_of(found, [&](auto it) { return it == empty.end(); }));
+
+    // a range constructor that throws destroys every node once
+    {
+        std::vector<std::pair<int, Alive>> alive(5);
+        for (int i = 0; i < 5; ++i) {
+            alive[i].first = i;
+        }
+        using Throwing = UnorderedMap<int, Alive, SameHash, ThirdCallThrows>;
+        REQUIRE_THROWS_AS(Throwing(alive.begin(), alive.end()), std::runtime_error);
+        REQUIRE(Alive::count == 5);
+    }
+    REQUIRE(Alive::count == 0);
+}
+
+TEST_CASE("Snapshot") {
+    struct Point {
+        int x;
+        double y;
+    };
+    UnorderedMap<uint64_t, Point> map;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.emplace(i * 7, Point{static_cast<int>(i), static_cast<double>(i) / 2});
+    }
+    std::string path = (std::filesystem::temp_directory_path() / "unordered_map_snapshot").string();
+    save_snapshot(map, path);
+
+    std::optional<UnorderedMapSnapshot<uint64_t, Point>> snapshot;
+    snapshot.emplace(path);
+    REQUIRE(snapshot->size() == map.size());
+    for (uint64_t i = 0; i < 10000; ++i) {
+        const Point* point = snapshot->find(i * 7);
+        REQUIRE(point != nullptr);
+        REQUIRE(point->x == static_cast<int>(i));
+        REQUIRE(point->y == static_cast<double>(i) / 2);
+        REQUIRE_FALSE(snapshot->contains(i * 7 + 1));
+    }
+    REQUIRE_THROWS_AS(snapshot->at(1), std::out_of_range);
+    REQUIRE(std::distance(snapshot->begin(), snapshot->end()) == 10000);
+
+    // the mapping outlives the file name, and a moved-from snapshot owns nothing
+    std::filesystem::remove(path);
+    auto moved = std::move(*snapshot);
+    snapshot.reset();
+    REQUIRE(moved.at(70).x == 10);
+
+    REQUIRE_THROWS_AS((UnorderedMapSnapshot<uint64_t, int>(path)), std::system_error);
+    save_snapshot(map, path);
+    REQUIRE_THROWS_AS((UnorderedMapSnapshot<uint64_t, int>(path)), std::runtime_error);
+    std::ofstream(path) << "definitely not a snapshot, but long enough to hold a header";
+    REQUIRE_THROWS_AS((UnorderedMapSnapshot<uint64_t, Point>(path)), std::runtime_error);
+
+    save_snapshot(UnorderedMap<uint64_t, Point>(), path);
+    UnorderedMapSnapshot<uint64_t, Point> empty(path);
+    REQUIRE(empty.empty());
+    REQUIRE(empty.find(0) == nullptr);
+
+    // saving over a mapped snapshot leaves the old mapping intact
+    save_snapshot(map, path);
+    UnorderedMapSnapshot<uint64_t, Point> old(path);
+    UnorderedMap<uint64_t, Point> other;
+    other.emplace(1, Point{-1, -1});
+    save_snapshot(other, path);
+    REQUIRE(old.size() == 10000);
+    REQUIRE(old.at(70).x == 10);
+    REQUIRE(UnorderedMapSnapshot<uint64_t, Point>(path).at(1).x == -1);
+    // and leaves no temporary file behind
+    auto temp_files = std::filesystem::directory_iterator(std::filesystem::temp_directory_path());
+    for (const auto& file : temp_files) {
+        REQUIRE_FALSE(file.path().filename().string().starts_with("unordered_map_snapshot."));
+    }
+
+    // neither the key nor the value has to be default constructible
+    struct Id {
+        explicit Id(uint64_t id)
+            : value(id) {
+        }
+        bool operator==(const Id&) const = default;
+
+        uint64_t value;
+    };
+    struct IdHash {
+        size_t operator()(Id id) const {
+            return std::hash<uint64_t>()(id.value);
+        }
+    };
+    UnorderedMap<Id, Id, IdHash> ids;
+    ids.emplace(Id(3), Id(4));
+    save_snapshot(ids, path);
+    REQUIRE(UnorderedMapSnapshot<Id, Id, IdHash>(path).at(Id(3)) == Id(4));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("FrozenMap") {
+    UnorderedMap<std::string, int> map;
+    for (int i = 0; i < 20000; ++i) {
+        map.emplace("key" + std::to_string(i), i);
+    }
+    auto frozen = map.freeze();
+    REQUIRE(frozen.size() == map.size());
+    for (int i = 0; i < 20000; ++i) {
+        auto it = frozen.find("key" + std::to_string(i));
+        REQUIRE(it != frozen.end());
+        REQUIRE(it->second == i);
+        REQUIRE_FALSE(frozen.contains("miss" + std::to_string(i)));
+    }
+    REQUIRE_THROWS_AS(frozen.at("key"), std::out_of_range);
+    // every slot holds a key
+    size_t sum = 0;
+    for (const auto& [key, value] : frozen) {
+        sum += static_cast<size_t>(value);
+    }
+    REQUIRE(sum == size_t{20000} * 19999 / 2);
+
+    for (int size = 0; size < 40; ++size) {
+        std::vector<std::pair<int, int>> pairs;
+        for (int i = 0; i < size; ++i) {
+            pairs.emplace_back(i * 31, i);
+        }
+        FrozenMap<int, int> small(pairs.begin(), pairs.end());
+        REQUIRE(small.size() == pairs.size());
+        for (const auto& [key, value] : pairs) {
+            REQUIRE(small.at(key) == value);
+        }
+        REQUIRE_FALSE(small.contains(1));
+    }
+
+    std::vector<std::pair<int, int>> duplicates = {{1, 1}, {2, 2}, {1, 3}};
+    REQUIRE_THROWS_AS((FrozenMap<int, int>(duplicates.begin(), duplicates.end())),
+                      std::invalid_argument);
+}
+
+// has no default constructor: every copy counts into the same place
+template <typename T>
+struct CountingArenaAllocator {
+    using value_type = T;
+
+    size_t* allocations;
+
+    explicit CountingArenaAllocator(size_t* counter)
+        : allocations(counter) {
+    }
+
+    template <typename U>
+    CountingArenaAllocator(const CountingArenaAllocator<U>& other)
+        : allocations(other.allocations) {
+    }
+
+    T* allocate(size_t n) {
+        ++*allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* pointer, size_t n) {
+        std::allocator<T>().deallocate(pointer, n);
+    }
+
+    bool operator==(const CountingArenaAllocator& other) const {
+        return allocations == other.allocations;
+    }
+};
+
+TEST_CASE("ConcurrentUnorderedMap") {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 20'000;
+    ConcurrentUnorderedMap<int, int, std::hash<int>, std::equal_to<int>,
+                           std::allocator<std::pair<const int, int>>, 8>
+        map;
+
+    std::vector<std::thread> threads;
+    std::vector<int> misses(kThreads, 0);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&map, &misses, t] {
+            for (int i = t * kPerThread; i < (t + 1) * kPerThread; ++i) {
+                map.emplace(i, i);
+                if (map.find(i) != i) {
+                    ++misses[t];
+                }
+                // readers of keys the other threads are writing right now
+                std::ignore = map.contains((i + kPerThread) % (kThreads * kPerThread));
+            }
+            for (int i = t * kPerThread; i < (t + 1) * kPerThread; i += 2) {
+                map.modify(i, [](int& value) { value = -value; });
+                map.erase(i + 1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(misses == std::vector<int>(kThreads, 0));
+    REQUIRE(map.size() == kThreads * kPerThread / 2);
+    REQUIRE_FALSE(map.find(1).has_value());
+    int sum = 0;
+    map.for_each([&sum](const auto& node) {
+        REQUIRE(node.first == -node.second);
+        ++sum;
+    });
+    REQUIRE(sum == kThreads * kPerThread / 2);
+    REQUIRE(map.visit(2, [](int value) { REQUIRE(value == -2); }));
+    REQUIRE_FALSE(map.insert_or_assign(2, 5));
+    REQUIRE(map.find(2) == 5);
+
+    // the shards are built from the allocator, it is never default constructed
+    size_t allocations = 0;
+    using Arena = CountingArenaAllocator<std::pair<const int, int>>;
+    ConcurrentUnorderedMap<int, int, std::hash<int>, std::equal_to<int>, Arena, 4> arena{
+        std::hash<int>(), std::equal_to<int>(), Arena(&allocations)};
+    for (int i = 0; i < 100; ++i) {
+        arena.emplace(i, i);
+    }
+    REQUIRE(arena.size() == 100);
+    REQUIRE(arena.find(42) == 42);
+    REQUIRE(allocations >= 100);
+}
+
+inline size_t live_allocations = 0;
+// the allocation that throws, counting down; 0 never throws
+inline size_t failing_allocation = 0;
+
+template <typename T>
+struct FailingAllocator : std::allocator<T> {
+    FailingAllocator() = default;
+
+    template <typename U>
+    FailingAllocator(const FailingAllocator<U>&) {
+    }
+
+    T* allocate(size_t n) {
+        if (failing_allocation > 0 && --failing_allocation == 0) {
+            throw std::bad_alloc();
+        }
+        ++live_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        --live_allocations;
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    struct rebind {
+        using other = FailingAllocator<U>;
+    };
+};
+
+TEST_CASE("RcuUnorderedMap") {
+    SECTION("Same as std::unordered_map") {
+        RcuUnorderedMap<int, std::string> map;
+        std::unordered_map<int, std::string> expected;
+        std::mt19937 gen(3);
+        for (int i = 0; i < 50'000; ++i) {
+            int k = static_cast<int>(gen() % 3000);
+            switch (gen() % 4) {
+                case 0:
+                    REQUIRE(map.emplace(k, std::to_string(i)) ==
+                            expected.emplace(k, std::to_string(i)).second);
+                    break;
+                case 1:
+                    map.insert_or_assign(k, std::to_string(k));
+                    expected.insert_or_assign(k, std::to_string(k));
+                    break;
+                case 2:
+                    REQUIRE(map.erase(k) == expected.erase(k));
+                    break;
+                default:
+                    REQUIRE(map.find(k) == (expected.contains(k)
+                                                ? std::optional(expected.at(k))
+                                                : std::nullopt));
+            }
+        }
+        REQUIRE(map.size() == expected.size());
+        size_t seen = 0;
+        map.for_each([&](const auto& node) {
+            REQUIRE(expected.at(node.first) == node.second);
+            ++seen;
+        });
+        REQUIRE(seen == expected.size());
+    }
+
+    SECTION("Readers during writes") {
+        // values are always key * 10 + something below 10, whatever version a reader sees
+        RcuUnorderedMap<int, int> map;
+        constexpr int kKeys = 1000;
+        for (int i = 0; i < kKeys; i += 2) {
+            map.emplace(i, i * 10);
+        }
+        std::atomic<bool> done = false;
+        std::atomic<int> broken = 0;
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 3; ++t) {
+            readers.emplace_back([&] {
+                while (!done.load()) {
+                    for (int i = 0; i < kKeys; ++i) {
+                        auto value = map.find(i);
+                        if (value && *value / 10 != i) {
+                            ++broken;
+                        }
+                    }
+                }
+            });
+        }
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < kKeys; ++i) {
+                if ((i + round) % 3 == 0) {
+                    map.erase(i);
+                } else {
+                    map.insert_or_assign(i, i * 10 + round % 10);
+                }
+            }
+        }
+        done = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        map.reclaim();
+        REQUIRE(broken == 0);
+    }
+
+    SECTION("Failed allocations") {
+        {
+            // one chain, the first key is at its end
+            RcuUnorderedMap<int, int, SameHash, std::equal_to<int>,
+                            FailingAllocator<std::pair<const int, int>>>
+                map;
+            for (int i = 0; i < 10; ++i) {
+                map.emplace(i, i);
+            }
+            // the element and its cell are made, the copy of the prefix fails
+            failing_allocation = 3;
+            REQUIRE_THROWS_AS(map.insert_or_assign(0, 100), std::bad_alloc);
+            REQUIRE(map.find(0) == 0);
+
+            // the 17th element outgrows 16 buckets, the new table fails
+            for (int i = 10; i < 16; ++i) {
+                map.emplace(i, i);
+            }
+            failing_allocation = 3;
+            REQUIRE(map.emplace(16, 16));
+            REQUIRE(map.find(16) == 16);
+            REQUIRE(map.emplace(17, 17));
+            REQUIRE(map.size() == 18);
+        }
+        {
+            // a comparison throws while the new element looks for its key
+            RcuUnorderedMap<int, int, SameHash, ThirdCallThrows,
+                            FailingAllocator<std::pair<const int, int>>>
+                map;
+            ThirdCallThrows::calls = 0;
+            map.emplace(0, 0);
+            map.emplace(1, 1);
+            REQUIRE_THROWS_AS(map.emplace(2, 2), std::runtime_error);
+            REQUIRE(map.size() == 2);
+        }
+        failing_allocation = 0;
+        REQUIRE(live_allocations == 0);
+    }
+}
+
+TEST_CASE("FlatUnorderedMap") {
+    SECTION("Basic") {
+        FlatUnorderedMap<std::string, int> map;
+        REQUIRE(map.empty());
+        REQUIRE(map.find("a") == map.end());
+        map["a"] = 1;
+        map.emplace("b", 2);
+        map.insert({"c", 3});
+        REQUIRE(map.size() == 3);
+        REQUIRE(map.at("b") == 2);
+        REQUIRE_THROWS_AS(map.at("d"), std::out_of_range);
+        REQUIRE_FALSE(map.emplace("a", 10).second);
+        REQUIRE(map["a"] == 1);
+        REQUIRE(map.erase("a") == 1);
+        REQUIRE(map.erase("a") == 0);
+        REQUIRE_FALSE(map.contains("a"));
+        REQUIRE(std::distance(map.begin(), map.end()) == 2);
+    }
+
+    SECTION("Same as std::unordered_map") {
+        FlatUnorderedMap<int, int> map;
+        std::unordered_map<int, int> expected;
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> key(0, 5000);
+        for (int i = 0; i < 200000; ++i) {
+            int k = key(gen);
+            switch (gen() % 4) {
+                case 0:
+                case 1:
+                    REQUIRE(map.emplace(k, i).second == expected.emplace(k, i).second);
+                    break;
+                case 2:
+                    REQUIRE(map.erase(k) == expected.erase(k));
+                    break;
+                default:
+                    REQUIRE(map.contains(k) == expected.contains(k));
+            }
+            REQUIRE(map.size() == expected.size());
+            REQUIRE(map.load_factor() <= map.max_load_factor());
+        }
+        for (const auto& [k, v] : expected) {
+            REQUIRE(map.at(k) == v);
+        }
+        REQUIRE(static_cast<size_t>(std::distance(map.begin(), map.end())) == expected.size());
+
+        auto copy = map;
+        map.clear();
+        REQUIRE(map.empty());
+        REQUIRE(map.begin() == map.end());
+        REQUIRE(copy.size() == expected.size());
+        auto moved = std::move(copy);
+        for (const auto& [k, v] : expected) {
+            REQUIRE(moved.at(k) == v);
+        }
+    }
+
+    SECTION("Copies build each element once") {
+        struct Counted {
+            int* built;
+
+            explicit Counted(int* counter)
+                : built(counter) {
+            }
+            Counted(const Counted& other)
+                : built(other.built) {
+                ++*built;
+            }
+            Counted(Counted&& other) noexcept
+                : built(other.built) {
+                ++*built;
+            }
+        };
+
+        int built = 0;
+        FlatUnorderedMap<int, Counted> map;
+        map.reserve(200);
+        for (int i = 0; i < 100; ++i) {
+            map.try_emplace(i, &built);
+        }
+        REQUIRE(built == 0);
+        auto copy = map;
+        REQUIRE(built == 100);
+
+        std::vector<std::pair<const int, Counted>> nodes;
+        nodes.reserve(100);
+        for (int i = 100; i < 200; ++i) {
+            nodes.emplace_back(std::piecewise_construct, std::forward_as_tuple(i),
+                               std::forward_as_tuple(&built));
+        }
+        copy.reserve(200);
+        built = 0;
+        copy.insert(nodes.begin(), nodes.end());
+        REQUIRE(built == 100);
+        REQUIRE(copy.size() == 200);
+    }
+
+    SECTION("Erase while iterating") {
+        FlatUnorderedMap<int, std::string> map;
+        map.reserve(1000);
+        size_t buckets = map.bucket_count();
+        for (int i = 0; i < 1000; ++i) {
+            map.emplace(i, std::to_string(i));
+        }
+        REQUIRE(map.bucket_count() == buckets);
+        for (auto it = map.begin(); it != map.end();) {
+            it = it->first % 2 == 0 ? map.erase(it) : std::next(it);
+        }
+        REQUIRE(map.size() == 500);
+        for (int i = 0; i < 1000; ++i) {
+            REQUIRE(map.contains(i) == (i % 2 == 1));
+        }
+    }
+}
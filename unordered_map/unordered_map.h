@@ -1,5 +1,996 @@
-template <typename, typename, typename, typename, typename>
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../stackallocator/stackallocator.h"
+#include "frozen_map.h"
+
+// Chained hash table over one List. Elements of a bucket are kept next to each
+// other in the list and the bucket array stores an iterator to the first of
+// them, so iteration is a plain walk over the list and nodes never move.
+// Every node caches the full hash of its key: rehash never calls Hash and
+// lookup calls Equal only when the hashes match.
+//
+// With incremental_rehash(true) growing the table doesn't relink every node at
+// once. The old bucket array is kept alongside the new one and each insertion
+// moves a few old buckets over. While that goes on the list is split in two:
+// migrated nodes form the new-table runs at its front, the rest keep their
+// old-table runs behind old_begin_.
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Value>>>
 class UnorderedMap {
+public:
+    using NodeType = std::pair<const Key, Value>;
+
+private:
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    // NodeType is constructed in place through Alloc, the list only owns memory
+    struct entry {
+        size_t hash;
+        alignas(NodeType) unsigned char storage[sizeof(NodeType)];
+
+        entry() {
+        }
+
+        NodeType* node() {
+            return std::launder(reinterpret_cast<NodeType*>(storage));
+        }
+
+        const NodeType* node() const {
+            return std::launder(reinterpret_cast<const NodeType*>(storage));
+        }
+    };
+
+    using entry_alloc_type = typename alloc_traits::template rebind_alloc<entry>;
+    using list_type = List<entry, entry_alloc_type>;
+    using list_iterator = typename list_type::iterator;
+    using bucket_alloc_type = typename alloc_traits::template rebind_alloc<list_iterator>;
+    using bucket_vector = std::vector<list_iterator, bucket_alloc_type>;
+
+    // old buckets moved to the new table per insertion
+    static constexpr size_t kRehashStep = 4;
+    // how many keys ahead find_batch starts fetching a bucket
+    static constexpr size_t kPrefetchDistance = 8;
+
+    list_type list_;
+    // iterator to the first node of the bucket, default-constructed if it is empty
+    bucket_vector buckets_;
+    float max_load_factor_ = 1.0f;
+
+    // non-empty only while an incremental rehash is in progress; old buckets
+    // with index below migrate_pos_ are already moved
+    bucket_vector old_buckets_;
+    size_t migrate_pos_ = 0;
+    // first node still in the old table, default-constructed if there is none
+    list_iterator old_begin_;
+    bool incremental_ = false;
+
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] Equal equal_;
+
+    template <bool IsConst>
+    class BaseIterator {
+    public:
+        friend class UnorderedMap;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = NodeType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const NodeType*, NodeType*>;
+        using reference = std::conditional_t<IsConst, const NodeType&, NodeType&>;
+
+        BaseIterator() = default;
+
+        BaseIterator(const BaseIterator&) = default;
+
+        BaseIterator& operator=(const BaseIterator&) = default;
+
+        BaseIterator(const BaseIterator<false>& other)
+            requires IsConst
+            : it_(other.it_) {
+        }
+
+        reference operator*() const {
+            return *it_->node();
+        }
+
+        pointer operator->() const {
+            return it_->node();
+        }
+
+        BaseIterator& operator++() {
+            ++it_;
+            return *this;
+        }
+
+        BaseIterator operator++(int) {
+            BaseIterator copy = *this;
+            ++it_;
+            return copy;
+        }
+
+        bool operator==(const BaseIterator& other) const {
+            return it_ == other.it_;
+        }
+
+    private:
+        template <bool>
+        friend class BaseIterator;
+
+        using list_iter = std::conditional_t<IsConst, typename list_type::const_iterator,
+                                             list_iterator>;
+
+        list_iter it_;
+
+        explicit BaseIterator(list_iter it)
+            : it_(it) {
+        }
+    };
+
+public:
+    using iterator = BaseIterator<false>;
+    using const_iterator = BaseIterator<true>;
+
+    // Owns one element taken out of a map, node and all. Inserting it into
+    // another map with an equal allocator only relinks the node.
+    class NodeHandle {
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using allocator_type = Alloc;
+
+        NodeHandle() = default;
+
+        NodeHandle(NodeHandle&& other) noexcept
+            : list_(std::move(other.list_)) {
+            other.list_.reset();
+        }
+
+        NodeHandle& operator=(NodeHandle&& other) noexcept {
+            if (this != &other) {
+                reset();
+                list_ = std::move(other.list_);
+                other.list_.reset();
+            }
+            return *this;
+        }
+
+        ~NodeHandle() {
+            reset();
+        }
+
+        bool empty() const {
+            return !list_ || list_->empty();
+        }
+
+        explicit operator bool() const {
+            return !empty();
+        }
+
+        // the key may be changed, it is rehashed on insertion
+        Key& key() const {
+            return const_cast<Key&>(list_->begin()->node()->first);
+        }
+
+        Value& mapped() const {
+            return const_cast<Value&>(list_->begin()->node()->second);
+        }
+
+        Alloc get_allocator() const {
+            return Alloc(list_->get_allocator());
+        }
+
+        void swap(NodeHandle& other) noexcept {
+            std::swap(list_, other.list_);
+        }
+
+    private:
+        friend class UnorderedMap;
+
+        std::optional<list_type> list_;
+
+        void reset() {
+            if (!empty()) {
+                Alloc alloc(list_->get_allocator());
+                alloc_traits::destroy(alloc, list_->begin()->node());
+            }
+            list_.reset();
+        }
+    };
+
+    struct insert_return_type {
+        iterator position;
+        bool inserted;
+        NodeHandle node;
+    };
+
+private:
+    Alloc node_allocator() const {
+        return Alloc(list_.get_allocator());
+    }
+
+    list_iterator list_end() const {
+        return const_cast<list_type&>(list_).end();
+    }
+
+    size_t bucket_index(size_t hash) const {
+        return hash & (buckets_.size() - 1);
+    }
+
+    size_t old_bucket_index(size_t hash) const {
+        return hash & (old_buckets_.size() - 1);
+    }
+
+    bool migrating() const {
+        return !old_buckets_.empty();
+    }
+
+    static size_t round_up_buckets(size_t count) {
+        size_t result = 1;
+        while (result < count) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    size_t buckets_needed(size_t count) const {
+        return round_up_buckets(
+            static_cast<size_t>(static_cast<float>(count) / max_load_factor_) + 1);
+    }
+
+    // walks one bucket run, which ends at stop or at a node of another bucket
+    template <typename K>
+    list_iterator find_in_run(list_iterator it, list_iterator stop, size_t mask, size_t index,
+                              const K& key, size_t hash) const {
+        if (it == list_iterator()) {
+            return list_end();
+        }
+        for (; it != stop && (it->hash & mask) == index; ++it) {
+            if (it->hash == hash && equal_(it->node()->first, key)) {
+                return it;
+            }
+        }
+        return list_end();
+    }
+
+    template <typename K>
+    list_iterator find_entry(const K& key, size_t hash) const {
+        list_iterator end = list_end();
+        if (buckets_.empty()) {
+            return end;
+        }
+        list_iterator stop = old_begin_ == list_iterator() ? end : old_begin_;
+        list_iterator found = find_in_run(buckets_[bucket_index(hash)], stop, buckets_.size() - 1,
+                                          bucket_index(hash), key, hash);
+        if (found != end || !migrating() || old_bucket_index(hash) < migrate_pos_) {
+            return found;
+        }
+        return find_in_run(old_buckets_[old_bucket_index(hash)], end, old_buckets_.size() - 1,
+                           old_bucket_index(hash), key, hash);
+    }
+
+    // moves a detached node from source to the head of its bucket
+    void link_entry(list_type& source, list_iterator it) {
+        list_iterator& first = buckets_[bucket_index(it->hash)];
+        list_.splice(first == list_iterator() ? list_.begin() : first, source, it);
+        first = it;
+    }
+
+    void stop_migration() {
+        bucket_vector(old_buckets_.get_allocator()).swap(old_buckets_);
+        migrate_pos_ = 0;
+        old_begin_ = list_iterator();
+    }
+
+    // rebuilds the bucket array by relinking nodes, no element is touched
+    void rebuild(size_t count) {
+        bucket_vector buckets(count, list_iterator(), bucket_alloc_type(list_.get_allocator()));
+        list_type nodes(list_.get_allocator());
+        nodes.splice(nodes.end(), list_);
+        buckets_.swap(buckets);
+        stop_migration();
+        while (!nodes.empty()) {
+            link_entry(nodes, nodes.begin());
+        }
+    }
+
+    // the current table becomes the old one, every node stays where it is
+    void start_migration(size_t count) {
+        bucket_vector buckets(count, list_iterator(), bucket_alloc_type(list_.get_allocator()));
+        old_buckets_.swap(buckets_);
+        buckets_.swap(buckets);
+        migrate_pos_ = 0;
+        old_begin_ = list_.begin();
+    }
+
+    // moves up to count old buckets into the new table
+    void migrate(size_t count) {
+        size_t mask = old_buckets_.size() - 1;
+        for (; count > 0 && migrate_pos_ < old_buckets_.size(); --count, ++migrate_pos_) {
+            list_iterator& head = old_buckets_[migrate_pos_];
+            while (head != list_iterator()) {
+                list_iterator it = head;
+                list_iterator next = std::next(it);
+                bool same_bucket = next != list_.end() && (next->hash & mask) == migrate_pos_;
+                head = same_bucket ? next : list_iterator();
+                if (it == old_begin_) {
+                    old_begin_ = next == list_.end() ? list_iterator() : next;
+                }
+                link_entry(list_, it);
+            }
+        }
+        if (migrate_pos_ == old_buckets_.size()) {
+            stop_migration();
+        }
+    }
+
+    void reserve_for(size_t count) {
+        if (migrating()) {
+            migrate(kRehashStep);
+        }
+        if (static_cast<float>(count) <= static_cast<float>(buckets_.size()) * max_load_factor_) {
+            return;
+        }
+        size_t new_count = std::max(buckets_.size() * 2, buckets_needed(count));
+        if (!incremental_ || empty()) {
+            rebuild(new_count);
+            return;
+        }
+        // the new table filled up before the last migration finished
+        migrate(old_buckets_.size());
+        start_migration(new_count);
+    }
+
+    void destroy_node(list_iterator it) {
+        Alloc alloc = node_allocator();
+        alloc_traits::destroy(alloc, it->node());
+    }
+
+    // constructs NodeType in a fresh node of the one-element list pending
+    template <typename... Args>
+    list_iterator make_entry(list_type& pending, Args&&... args) {
+        list_iterator it = pending.emplace(pending.end());
+        Alloc alloc = node_allocator();
+        alloc_traits::construct(alloc, it->node(), std::forward<Args>(args)...);
+        return it;
+    }
+
+    // pending holds a node with NodeType and hash set; links it in unless
+    // the key is present, in which case the node is destroyed
+    std::pair<iterator, bool> insert_entry(list_type& pending, list_iterator it) {
+        try {
+            list_iterator found = find_entry(it->node()->first, it->hash);
+            if (found != list_end()) {
+                destroy_node(it);
+                return {iterator(found), false};
+            }
+            reserve_for(size() + 1);
+        } catch (...) {
+            destroy_node(it);
+            throw;
+        }
+        link_entry(pending, it);
+        return {iterator(it), true};
+    }
+
+    // an empty range erase is the way to drop const from a list iterator
+    list_iterator mutable_iterator(typename list_type::const_iterator it) {
+        return list_.erase(it, it);
+    }
+
+    // updates bucket heads and the old table boundary as if it were gone;
+    // the node itself is still linked
+    void unlink_buckets(list_iterator it) {
+        size_t hash = it->hash;
+        list_iterator next = std::next(it);
+        bool at_end = next == list_.end();
+        if (old_begin_ == it) {
+            old_begin_ = at_end ? list_iterator() : next;
+        }
+        size_t index = bucket_index(hash);
+        if (buckets_[index] == it) {
+            // a new-table run also ends where the old table begins
+            bool same_bucket = !at_end && next != old_begin_ && bucket_index(next->hash) == index;
+            buckets_[index] = same_bucket ? next : list_iterator();
+        }
+        if (migrating() && old_buckets_[old_bucket_index(hash)] == it) {
+            size_t old_index = old_bucket_index(hash);
+            bool same_bucket = !at_end && old_bucket_index(next->hash) == old_index;
+            old_buckets_[old_index] = same_bucket ? next : list_iterator();
+        }
+    }
+
+    // node.list_ holds one node with its hash set
+    insert_return_type insert_handle(NodeHandle&& node) {
+        list_iterator it = node.list_->begin();
+        list_iterator found = find_entry(it->node()->first, it->hash);
+        if (found != list_end()) {
+            return {iterator(found), false, std::move(node)};
+        }
+        reserve_for(size() + 1);
+        link_entry(*node.list_, it);
+        return {iterator(it), true, NodeHandle()};
+    }
+
+    // Hash and Equal that both declare is_transparent accept any key type they
+    // can handle, so lookups don't have to build a Key
+    static constexpr bool kTransparent = requires {
+        typename Hash::is_transparent;
+        typename Equal::is_transparent;
+    };
+
+    template <typename K>
+    list_iterator lookup(const K& key) const {
+        return find_entry(key, hash_(key));
+    }
+
+    template <typename K>
+    list_iterator checked_lookup(const K& key) const {
+        list_iterator it = lookup(key);
+        if (it == list_end()) {
+            throw std::out_of_range("UnorderedMap::at: no such key");
+        }
+        return it;
+    }
+
+    template <typename K>
+    size_t erase_key(const K& key) {
+        list_iterator it = lookup(key);
+        if (it == list_end()) {
+            return 0;
+        }
+        erase(const_iterator(it));
+        return 1;
+    }
+
+    template <typename K>
+    Value& subscript(K&& key) {
+        size_t hash = hash_(key);
+        list_iterator found = find_entry(key, hash);
+        if (found != list_end()) {
+            return found->node()->second;
+        }
+        list_type pending(list_.get_allocator());
+        list_iterator it = make_entry(pending, std::piecewise_construct,
+                                      std::forward_as_tuple(std::forward<K>(key)),
+                                      std::forward_as_tuple());
+        it->hash = hash;
+        try {
+            reserve_for(size() + 1);
+        } catch (...) {
+            destroy_node(it);
+            throw;
+        }
+        link_entry(pending, it);
+        return it->node()->second;
+    }
+
+    void copy_entries(const UnorderedMap& other) {
+        reserve_for(other.size());
+        for (const entry& source : other.list_) {
+            list_type pending(list_.get_allocator());
+            list_iterator it = make_entry(pending, *source.node());
+            it->hash = source.hash;
+            link_entry(pending, it);
+        }
+    }
+
+    void move_entries(UnorderedMap& other) {
+        reserve_for(other.size());
+        for (entry& source : other.list_) {
+            list_type pending(list_.get_allocator());
+            list_iterator it =
+                make_entry(pending, std::move(const_cast<Key&>(source.node()->first)),
+                           std::move(source.node()->second));
+            it->hash = source.hash;
+            link_entry(pending, it);
+        }
+        other.clear();
+    }
+
+    void destroy_all(list_type& nodes) {
+        Alloc alloc = node_allocator();
+        for (entry& item : nodes) {
+            alloc_traits::destroy(alloc, item.node());
+        }
+    }
+
+    // Builds and hashes every node before touching the table, so that it is
+    // resized at most once, then links them in. Of equal keys the first one
+    // wins, as with one insert() after another.
+    template <typename InputIt>
+    void bulk_insert(InputIt first, InputIt last) {
+        list_type pending(list_.get_allocator());
+        try {
+            for (; first != last; ++first) {
+                list_type fresh(list_.get_allocator());
+                list_iterator it = make_entry(fresh, *first);
+                try {
+                    it->hash = hash_(it->node()->first);
+                } catch (...) {
+                    destroy_node(it);
+                    throw;
+                }
+                pending.splice(pending.end(), fresh, it);
+            }
+            reserve(size() + pending.size());
+            while (!pending.empty()) {
+                list_iterator it = pending.begin();
+                if (find_entry(it->node()->first, it->hash) == list_end()) {
+                    link_entry(pending, it);
+                } else {
+                    destroy_node(it);
+                    pending.erase(it);
+                }
+            }
+        } catch (...) {
+            destroy_all(pending);
+            throw;
+        }
+    }
+
+    static void prefetch([[maybe_unused]] const void* address) {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#endif
+    }
+
+    // Software pipeline over the keys: 2 * kPrefetchDistance keys ahead the
+    // key is hashed and its bucket slot fetched, kPrefetchDistance ahead the
+    // slot is read and the first node of the run fetched. By the time a key is
+    // probed both are likely in cache. Calls found(list_iterator) per key.
+    template <typename Keys, typename Found>
+    void batch_lookup(const Keys& keys, Found&& found) const {
+        constexpr size_t kWindow = 2 * kPrefetchDistance;
+        auto key_at = [&keys](size_t i) -> decltype(auto) {
+            return std::ranges::begin(keys)[i];
+        };
+        size_t count = std::ranges::size(keys);
+        if (buckets_.empty()) {
+            for (size_t i = 0; i < count; ++i) {
+                found(list_end());
+            }
+            return;
+        }
+        // hash of key i lives in hashes[i % kWindow] until key i is probed
+        size_t hashes[kWindow];
+        auto fetch_bucket = [&](size_t i) {
+            hashes[i % kWindow] = hash_(key_at(i));
+            prefetch(&buckets_[bucket_index(hashes[i % kWindow])]);
+        };
+        auto fetch_node = [&](size_t i) {
+            list_iterator head = buckets_[bucket_index(hashes[i % kWindow])];
+            if (head != list_iterator()) {
+                prefetch(&*head);
+            }
+        };
+        for (size_t i = 0; i < std::min(count, kWindow); ++i) {
+            fetch_bucket(i);
+        }
+        for (size_t i = 0; i < std::min(count, kPrefetchDistance); ++i) {
+            fetch_node(i);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            found(find_entry(key_at(i), hashes[i % kWindow]));
+            // the slot of key i is free now
+            if (i + kWindow < count) {
+                fetch_bucket(i + kWindow);
+            }
+            if (i + kPrefetchDistance < count) {
+                fetch_node(i + kPrefetchDistance);
+            }
+        }
+    }
+
+public:
+    UnorderedMap()
+        : UnorderedMap(0) {
+    }
+
+    explicit UnorderedMap(size_t bucket_count, const Hash& hash = Hash(),
+                          const Equal& equal = Equal(), const Alloc& alloc = Alloc())
+        : list_(entry_alloc_type(alloc)),
+          buckets_(bucket_count == 0 ? 0 : round_up_buckets(bucket_count), list_iterator(),
+                   bucket_alloc_type(alloc)),
+          old_buckets_(bucket_alloc_type(alloc)),
+          hash_(hash),
+          equal_(equal) {
+    }
+
+    explicit UnorderedMap(const Alloc& alloc)
+        : UnorderedMap(0, Hash(), Equal(), alloc) {
+    }
+
+    // hashes the whole range first and sizes the table once. The delegated
+    // constructor has finished, so if bulk_insert throws the destructor
+    // destroys the nodes already linked
+    template <std::input_iterator InputIt>
+    UnorderedMap(InputIt first, InputIt last, size_t bucket_count = 0, const Hash& hash = Hash(),
+                 const Equal& equal = Equal(), const Alloc& alloc = Alloc())
+        : UnorderedMap(bucket_count, hash, equal, alloc) {
+        bulk_insert(first, last);
+    }
+
+    UnorderedMap(const UnorderedMap& other)
+        : UnorderedMap(other.bucket_count(), other.hash_, other.equal_,
+                       alloc_traits::select_on_container_copy_construction(
+                           other.get_allocator())) {
+        max_load_factor_ = other.max_load_factor_;
+        incremental_ = other.incremental_;
+        copy_entries(other);
+    }
+
+    UnorderedMap(UnorderedMap&& other) noexcept
+        : list_(std::move(other.list_)),
+          buckets_(std::move(other.buckets_)),
+          max_load_factor_(other.max_load_factor_),
+          old_buckets_(std::move(other.old_buckets_)),
+          migrate_pos_(std::exchange(other.migrate_pos_, 0)),
+          old_begin_(std::exchange(other.old_begin_, list_iterator())),
+          incremental_(other.incremental_),
+          hash_(std::move(other.hash_)),
+          equal_(std::move(other.equal_)) {
+    }
+
+    UnorderedMap& operator=(const UnorderedMap& other) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            list_.allocator = other.list_.allocator;
+        }
+        hash_ = other.hash_;
+        equal_ = other.equal_;
+        max_load_factor_ = other.max_load_factor_;
+        incremental_ = other.incremental_;
+        copy_entries(other);
+        return *this;
+    }
+
+    UnorderedMap& operator=(UnorderedMap&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        hash_ = std::move(other.hash_);
+        equal_ = std::move(other.equal_);
+        max_load_factor_ = other.max_load_factor_;
+        incremental_ = other.incremental_;
+        if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+            if (!(list_.allocator == other.list_.allocator)) {
+                // nodes of a foreign allocator can't be adopted
+                move_entries(other);
+                return *this;
+            }
+        }
+        list_ = std::move(other.list_);
+        buckets_ = std::move(other.buckets_);
+        old_buckets_ = std::move(other.old_buckets_);
+        migrate_pos_ = std::exchange(other.migrate_pos_, 0);
+        old_begin_ = std::exchange(other.old_begin_, list_iterator());
+        return *this;
+    }
+
+    ~UnorderedMap() {
+        destroy_all(list_);
+    }
+
+    void swap(UnorderedMap& other) noexcept {
+        list_.swap(other.list_);
+        buckets_.swap(other.buckets_);
+        old_buckets_.swap(other.old_buckets_);
+        std::swap(migrate_pos_, other.migrate_pos_);
+        std::swap(old_begin_, other.old_begin_);
+        std::swap(incremental_, other.incremental_);
+        std::swap(max_load_factor_, other.max_load_factor_);
+        std::swap(hash_, other.hash_);
+        std::swap(equal_, other.equal_);
+    }
+
+    Alloc get_allocator() const {
+        return node_allocator();
+    }
+
+    Hash hash_function() const {
+        return hash_;
+    }
+
+    Equal key_eq() const {
+        return equal_;
+    }
+
+    size_t size() const {
+        return list_.size();
+    }
+
+    bool empty() const {
+        return list_.empty();
+    }
+
+    iterator begin() {
+        return iterator(list_.begin());
+    }
+
+    const_iterator begin() const {
+        return const_iterator(list_.begin());
+    }
+
+    iterator end() {
+        return iterator(list_.end());
+    }
+
+    const_iterator end() const {
+        return const_iterator(list_.end());
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+    iterator find(const Key& key) {
+        return iterator(lookup(key));
+    }
+
+    const_iterator find(const Key& key) const {
+        return const_iterator(lookup(key));
+    }
+
+    template <typename K>
+        requires kTransparent
+    iterator find(const K& key) {
+        return iterator(lookup(key));
+    }
+
+    template <typename K>
+        requires kTransparent
+    const_iterator find(const K& key) const {
+        return const_iterator(lookup(key));
+    }
+
+    // Looks up every key of a random access range and writes the results,
+    // end() for a missing key, through out. Fetching buckets a few keys ahead
+    // hides most of the cache misses of a large table.
+    template <std::ranges::random_access_range Keys, typename OutIt>
+        requires std::ranges::sized_range<Keys>
+    void find_batch(const Keys& keys, OutIt out) {
+        batch_lookup(keys, [&out](list_iterator it) { *out++ = iterator(it); });
+    }
+
+    template <std::ranges::random_access_range Keys, typename OutIt>
+        requires std::ranges::sized_range<Keys>
+    void find_batch(const Keys& keys, OutIt out) const {
+        batch_lookup(keys, [&out](list_iterator it) { *out++ = const_iterator(it); });
+    }
+
+    bool contains(const Key& key) const {
+        return lookup(key) != list_end();
+    }
+
+    template <typename K>
+        requires kTransparent
+    bool contains(const K& key) const {
+        return lookup(key) != list_end();
+    }
+
+    size_t count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    template <typename K>
+        requires kTransparent
+    size_t count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    Value& at(const Key& key) {
+        return checked_lookup(key)->node()->second;
+    }
+
+    const Value& at(const Key& key) const {
+        return checked_lookup(key)->node()->second;
+    }
+
+    template <typename K>
+        requires kTransparent
+    Value& at(const K& key) {
+        return checked_lookup(key)->node()->second;
+    }
+
+    template <typename K>
+        requires kTransparent
+    const Value& at(const K& key) const {
+        return checked_lookup(key)->node()->second;
+    }
+
+    Value& operator[](const Key& key) {
+        return subscript(key);
+    }
+
+    Value& operator[](Key&& key) {
+        return subscript(std::move(key));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        // the key is only known once the node is built
+        list_type pending(list_.get_allocator());
+        list_iterator it = make_entry(pending, std::forward<Args>(args)...);
+        try {
+            it->hash = hash_(it->node()->first);
+        } catch (...) {
+            destroy_node(it);
+            throw;
+        }
+        return insert_entry(pending, it);
+    }
+
+    std::pair<iterator, bool> insert(const NodeType& node) {
+        return emplace(node);
+    }
+
+    std::pair<iterator, bool> insert(NodeType&& node) {
+        return emplace(std::move(node));
+    }
+
+    template <typename P>
+        requires std::is_constructible_v<NodeType, P&&>
+    std::pair<iterator, bool> insert(P&& value) {
+        return emplace(std::forward<P>(value));
+    }
+
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        bulk_insert(first, last);
+    }
+
+    iterator erase(const_iterator pos) {
+        list_iterator it = mutable_iterator(pos.it_);
+        list_iterator next = std::next(it);
+        unlink_buckets(it);
+        destroy_node(it);
+        list_.erase(it);
+        return iterator(next);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        while (first != last) {
+            first = erase(first);
+        }
+        return iterator(mutable_iterator(last.it_));
+    }
+
+    size_t erase(const Key& key) {
+        return erase_key(key);
+    }
+
+    template <typename K>
+        requires kTransparent && (!std::is_convertible_v<K, const_iterator>)
+    size_t erase(K&& key) {
+        return erase_key(key);
+    }
+
+    NodeHandle extract(const_iterator pos) {
+        list_iterator it = mutable_iterator(pos.it_);
+        unlink_buckets(it);
+        NodeHandle result;
+        result.list_.emplace(list_.get_allocator());
+        result.list_->splice(result.list_->end(), list_, it);
+        return result;
+    }
+
+    NodeHandle extract(const Key& key) {
+        list_iterator it = lookup(key);
+        return it == list_end() ? NodeHandle() : extract(const_iterator(it));
+    }
+
+    template <typename K>
+        requires kTransparent && (!std::is_convertible_v<K, const_iterator>)
+    NodeHandle extract(K&& key) {
+        list_iterator it = lookup(key);
+        return it == list_end() ? NodeHandle() : extract(const_iterator(it));
+    }
+
+    // requires node.get_allocator() == get_allocator()
+    insert_return_type insert(NodeHandle&& node) {
+        if (node.empty()) {
+            return {end(), false, NodeHandle()};
+        }
+        list_iterator it = node.list_->begin();
+        it->hash = hash_(it->node()->first);
+        return insert_handle(std::move(node));
+    }
+
+    // Moves every element whose key is missing here out of other, relinking
+    // nodes instead of allocating. Requires equal allocators.
+    void merge(UnorderedMap& other) {
+        if (&other == this) {
+            return;
+        }
+        reserve_for(size() + other.size());
+        for (auto it = other.begin(); it != other.end();) {
+            auto current = it++;
+            // a cached hash is only reusable while the hash functor has no state
+            size_t hash = std::is_empty_v<Hash> ? current.it_->hash : hash_(current->first);
+            if (find_entry(current->first, hash) == list_end()) {
+                NodeHandle node = other.extract(current);
+                node.list_->begin()->hash = hash;
+                insert_handle(std::move(node));
+            }
+        }
+    }
+
+    void merge(UnorderedMap&& other) {
+        merge(other);
+    }
+
+    void clear() {
+        destroy_all(list_);
+        list_.clear();
+        std::fill(buckets_.begin(), buckets_.end(), list_iterator());
+        stop_migration();
+    }
+
+    // immutable copy with one-probe lookups, see FrozenMap
+    FrozenMap<Key, Value, Hash, Equal, Alloc> freeze() const {
+        return FrozenMap<Key, Value, Hash, Equal, Alloc>(begin(), end(), hash_, equal_,
+                                                         node_allocator());
+    }
+
+    void reserve(size_t count) {
+        if (buckets_needed(count) > buckets_.size()) {
+            rebuild(buckets_needed(count));
+        }
+    }
+
+    size_t bucket_count() const {
+        return buckets_.size();
+    }
+
+    float load_factor() const {
+        return buckets_.empty() ? 0.0f
+                                : static_cast<float>(size()) / static_cast<float>(buckets_.size());
+    }
+
+    float max_load_factor() const {
+        return max_load_factor_;
+    }
+
+    // Incremental rehash bounds the latency of a single insertion at the cost
+    // of slightly slower lookups while two tables coexist. reserve() and
+    // max_load_factor() still rehash everything at once.
+    void incremental_rehash(bool enabled) {
+        incremental_ = enabled;
+        if (!enabled && migrating()) {
+            migrate(old_buckets_.size());
+        }
+    }
+
+    bool incremental_rehash() const {
+        return incremental_;
+    }
 
-    // YOUR CODE HERE
-};
\ No newline at end of file
+    void max_load_factor(float value) {
+        max_load_factor_ = value;
+        reserve(size());
+    }
+};
@@ -0,0 +1,293 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "util.h"
+#include "variant.h"
+#include "variant_vector.h"
+
+template <size_t I>
+struct Tag {
+    uint64_t value = I;
+};
+
+template <size_t... Is>
+auto make_std_variant(std::index_sequence<Is...>) -> std::variant<Tag<Is>...>;
+
+template <size_t... Is>
+auto make_variant(std::index_sequence<Is...>) -> Variant<Tag<Is>...>;
+
+template <typename Body>
+double measure(Body&& body) {
+    Timer timer;
+    body();
+    return std::chrono::duration<double, std::milli>(timer.GetTimes().wall_time).count();
+}
+
+// alternatives are picked at random, so the branch predictor can't guess the
+// index and dispatch shows up in full
+template <size_t N>
+void run(const std::vector<size_t>& indices) {
+    using StdVariant = decltype(make_std_variant(std::make_index_sequence<N>()));
+    using OurVariant = decltype(make_variant(std::make_index_sequence<N>()));
+    std::vector<StdVariant> std_variants;
+    std::vector<OurVariant> variants;
+    for (size_t index : indices) {
+        variant_detail::dispatch<N>(index % N, [&]<size_t I>(std::integral_constant<size_t, I>) {
+            std_variants.emplace_back(std::in_place_index<I>);
+            variants.emplace_back().template emplace<I>();
+        });
+    }
+
+    // the visitor does something different per alternative, like real code
+    auto visitor = []<size_t I>(const Tag<I>& tag) { return tag.value * (I + 1); };
+    uint64_t sum = 0;
+    double std_time = measure([&] {
+        for (int round = 0; round < 10; ++round) {
+            for (const auto& variant : std_variants) {
+                sum += std::visit(visitor, variant);
+            }
+        }
+    });
+    double our_time = measure([&] {
+        for (int round = 0; round < 10; ++round) {
+            for (const auto& variant : variants) {
+                sum += visit(visitor, variant);
+            }
+        }
+    });
+    std::cout << N << '\t' << std_time << '\t' << our_time << "\t(" << sum << ")\n";
+}
+
+// the obvious way to visit several variants: one visit nested in another
+template <typename Visitor, typename First, typename... Rest>
+decltype(auto) nested_visit(Visitor&& visitor, First&& first, Rest&&... rest) {
+    if constexpr (sizeof...(Rest) == 0) {
+        return visit(visitor, first);
+    } else {
+        return visit(
+            [&](auto& value) {
+                return nested_visit([&](auto&... tail) { return visitor(value, tail...); },
+                                    rest...);
+            },
+            first);
+    }
+}
+
+namespace machine {
+
+struct Idle {
+    static constexpr size_t kIndex = 0;
+};
+struct Running {
+    static constexpr size_t kIndex = 1;
+};
+struct Paused {
+    static constexpr size_t kIndex = 2;
+};
+struct Stopped {
+    static constexpr size_t kIndex = 3;
+};
+
+struct Start {};
+struct Pause {};
+struct Resume {};
+struct Stop {};
+struct Tick {};
+
+struct Fast {};
+struct Slow {};
+struct Safe {};
+
+template <template <typename...> typename V>
+using State = V<Idle, Running, Paused, Stopped>;
+
+template <template <typename...> typename V>
+using Event = V<Start, Pause, Resume, Stop, Tick>;
+
+template <template <typename...> typename V>
+using Mode = V<Fast, Slow, Safe>;
+
+// next state as an index; anything not listed keeps the state
+struct Transition {
+    size_t operator()(const Idle&, const Start&) const {
+        return 1;
+    }
+    size_t operator()(const Running&, const Pause&) const {
+        return 2;
+    }
+    size_t operator()(const Paused&, const Resume&) const {
+        return 1;
+    }
+    size_t operator()(const auto&, const Stop&) const {
+        return 3;
+    }
+    size_t operator()(const Stopped&, const Start&) const {
+        return 0;
+    }
+    template <typename S, typename E>
+    size_t operator()(const S&, const E&) const {
+        return S::kIndex;
+    }
+
+    // the mode decides whether ticks may pause a running machine
+    template <typename S, typename E>
+    size_t operator()(const S& state, const E& event, const Fast&) const {
+        return (*this)(state, event);
+    }
+    template <typename S, typename E>
+    size_t operator()(const S& state, const E& event, const Slow&) const {
+        if constexpr (std::is_same_v<S, Running> && std::is_same_v<E, Tick>) {
+            return 2;
+        }
+        return (*this)(state, event);
+    }
+    template <typename S, typename E>
+    size_t operator()(const S& state, const E& event, const Safe&) const {
+        if constexpr (std::is_same_v<E, Stop>) {
+            return S::kIndex;
+        }
+        return (*this)(state, event);
+    }
+};
+
+}  // namespace machine
+
+// Feeds random events through a state machine: visit(transition, state,
+// event), and the same with a third variant for the mode. Returns the time.
+template <template <typename...> typename V, typename Visit>
+double run_machine(Visit&& visit_fn, const std::vector<size_t>& events, bool with_mode,
+                   uint64_t& visited) {
+    using namespace machine;
+    State<V> states[] = {Idle(), Running(), Paused(), Stopped()};
+    std::vector<Event<V>> inputs;
+    std::vector<Mode<V>> modes;
+    Event<V> all_events[] = {Start(), Pause(), Resume(), Stop(), Tick()};
+    Mode<V> all_modes[] = {Fast(), Slow(), Safe()};
+    for (size_t event : events) {
+        inputs.push_back(all_events[event % 5]);
+        modes.push_back(all_modes[event / 5 % 3]);
+    }
+    return measure([&] {
+        size_t state = 0;
+        for (int round = 0; round < 10; ++round) {
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                state = with_mode ? visit_fn(Transition(), states[state], inputs[i], modes[i])
+                                  : visit_fn(Transition(), states[state], inputs[i]);
+                visited += state;
+            }
+        }
+    });
+}
+
+void run_machines(const std::vector<size_t>& events) {
+    auto std_visit = [](auto&&... args) { return std::visit(args...); };
+    auto flat_visit = [](auto&&... args) { return visit(args...); };
+    auto nested = [](auto&&... args) { return nested_visit(args...); };
+
+    std::cout << "\nstate machine\tstd::visit\tnested\tvisit (ms)\n";
+    for (bool with_mode : {false, true}) {
+        uint64_t sum = 0;
+        double std_time = run_machine<std::variant>(std_visit, events, with_mode, sum);
+        double nested_time = run_machine<Variant>(nested, events, with_mode, sum);
+        double flat_time = run_machine<Variant>(flat_visit, events, with_mode, sum);
+        std::cout << (with_mode ? "3 variants" : "2 variants") << '\t' << std_time << '\t'
+                  << nested_time << '\t' << flat_time << "\t(" << sum << ")\n";
+    }
+}
+
+template <typename... Fs>
+struct Overload : Fs... {
+    using Fs::operator()...;
+};
+
+namespace events {
+
+struct Move {
+    float dx;
+    float dy;
+};
+struct Scale {
+    float factor;
+};
+struct Hit {
+    int damage;
+};
+
+}  // namespace events
+
+// The same heterogeneous events as a vector of variants, visited one by one,
+// and as a VariantVector, processed one type at a time.
+void run_events(const std::vector<size_t>& indices) {
+    using namespace events;
+    std::vector<Variant<Move, Scale, Hit>> variants;
+    VariantVector<Move, Scale, Hit> columns;
+    for (size_t index : indices) {
+        float value = static_cast<float>(index % 100);
+        switch (index % 3) {
+            case 0:
+                variants.emplace_back(Move{value, -value});
+                columns.push_back(Move{value, -value});
+                break;
+            case 1:
+                variants.emplace_back(Scale{value});
+                columns.push_back(Scale{value});
+                break;
+            default:
+                variants.emplace_back(Hit{static_cast<int>(index % 7)});
+                columns.push_back(Hit{static_cast<int>(index % 7)});
+        }
+    }
+
+    float x = 0;
+    float y = 0;
+    float scale = 0;
+    int health = 0;
+    auto process = Overload{
+        [&](const Move& move) {
+            x += move.dx;
+            y += move.dy;
+        },
+        [&](const Scale& event) { scale += event.factor; },
+        [&](const Hit& hit) { health -= hit.damage; },
+    };
+    double variant_time = measure([&] {
+        for (int round = 0; round < 10; ++round) {
+            for (const auto& variant : variants) {
+                visit(process, variant);
+            }
+        }
+    });
+    double column_time = measure([&] {
+        for (int round = 0; round < 10; ++round) {
+            std::as_const(columns).visit_all(process);
+        }
+    });
+    std::cout << "\nevents\tvector<Variant>\tVariantVector (ms)\n";
+    std::cout << "3 types\t" << variant_time << '\t' << column_time << "\t(" << x + y + scale
+              << ' ' << health << ")\n";
+}
+
+int main() {
+    constexpr size_t kSize = 1'000'000;
+    std::mt19937_64 gen(42);
+    std::vector<size_t> indices(kSize);
+    for (auto& index : indices) {
+        index = gen();
+    }
+
+    std::cout << "10 x " << kSize << " visits of a random alternative\n";
+    std::cout << "types\tstd::visit\tvisit (ms)\n";
+    run<2>(indices);
+    run<8>(indices);
+    run<64>(indices);
+    // past kSwitchLimit: the table of function pointers
+    run<128>(indices);
+
+    run_machines(indices);
+    run_events(indices);
+}
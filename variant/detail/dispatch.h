@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Turns a runtime index into a compile-time one: dispatch<N>(index, f) calls
+// f(std::integral_constant<size_t, index>()). Up to kSwitchLimit cases go
+// through a plain switch: the compiler inlines every case into one jump
+// table of code, with no call at all. Bigger ones go through a constexpr table
+// of function pointers, one indirect call.
+namespace variant_detail {
+
+// the switch in dispatch() has exactly this many cases
+inline constexpr size_t kSwitchLimit = 64;
+
+template <size_t I, typename R, typename F>
+R call_at(F&& f) {
+    return std::forward<F>(f)(std::integral_constant<size_t, I>());
+}
+
+template <typename R, typename F, size_t... Is>
+constexpr std::array<R (*)(F&&), sizeof...(Is)> make_jump_table(std::index_sequence<Is...>) {
+    return {&call_at<Is, R, F>...};
+}
+
+template <size_t N, typename R, typename F>
+inline constexpr auto kJumpTable = make_jump_table<R, F>(std::make_index_sequence<N>());
+
+template <size_t I, size_t N, typename R, typename F>
+R switch_case(F&& f) {
+    if constexpr (I < N) {
+        return call_at<I, R>(std::forward<F>(f));
+    } else {
+        std::unreachable();
+    }
+}
+
+template <size_t N, typename F>
+using dispatch_result_t = std::invoke_result_t<F, std::integral_constant<size_t, 0>>;
+
+// the kSwitchLimit cases of the switch below, written out by the preprocessor
+#define VARIANT_DISPATCH_CASE(I) \
+    case I:                      \
+        return switch_case<I, N, R>(std::forward<F>(f));
+#define VARIANT_DISPATCH_CASES_4(I)                          \
+    VARIANT_DISPATCH_CASE(I) VARIANT_DISPATCH_CASE(I + 1)    \
+    VARIANT_DISPATCH_CASE(I + 2) VARIANT_DISPATCH_CASE(I + 3)
+#define VARIANT_DISPATCH_CASES_16(I)                               \
+    VARIANT_DISPATCH_CASES_4(I) VARIANT_DISPATCH_CASES_4(I + 4)    \
+    VARIANT_DISPATCH_CASES_4(I + 8) VARIANT_DISPATCH_CASES_4(I + 12)
+#define VARIANT_DISPATCH_CASES_64(I)                                 \
+    VARIANT_DISPATCH_CASES_16(I) VARIANT_DISPATCH_CASES_16(I + 16)   \
+    VARIANT_DISPATCH_CASES_16(I + 32) VARIANT_DISPATCH_CASES_16(I + 48)
+
+static_assert(kSwitchLimit == 64, "the switch is stamped out by VARIANT_DISPATCH_CASES_64");
+
+// index < N
+template <size_t N, typename F, typename R = dispatch_result_t<N, F>>
+R dispatch(size_t index, F&& f) {
+    if constexpr (N <= kSwitchLimit) {
+        switch (index) {
+            VARIANT_DISPATCH_CASES_64(0)
+            default:
+                std::unreachable();
+        }
+    } else {
+        return kJumpTable<N, R, F>[index](std::forward<F>(f));
+    }
+}
+
+#undef VARIANT_DISPATCH_CASES_64
+#undef VARIANT_DISPATCH_CASES_16
+#undef VARIANT_DISPATCH_CASES_4
+#undef VARIANT_DISPATCH_CASE
+
+// row-major position K of an N_1 x ... x N_n table back to its indices
+template <size_t K, size_t... Ns>
+constexpr std::array<size_t, sizeof...(Ns)> unflatten() {
+    constexpr size_t kDims[] = {Ns..., 0};
+    std::array<size_t, sizeof...(Ns)> result{};
+    size_t rest = K;
+    for (size_t i = sizeof...(Ns); i-- > 0;) {
+        result[i] = rest % kDims[i];
+        rest /= kDims[i];
+    }
+    return result;
+}
+
+// Calls f(std::integral_constant<size_t, indices[0]>(), ...) for several
+// indices at once. They are combined into one row-major position in an
+// N_1 x ... x N_n table, so there is a single dispatch however many there
+// are, not one nested in another.
+template <size_t... Ns, typename F>
+decltype(auto) dispatch_all(const std::array<size_t, sizeof...(Ns)>& indices, F&& f) {
+    constexpr size_t kDims[] = {Ns..., 0};
+    size_t flat = 0;
+    for (size_t i = 0; i < sizeof...(Ns); ++i) {
+        flat = flat * kDims[i] + indices[i];
+    }
+    auto split = [&f]<size_t K>(std::integral_constant<size_t, K>) -> decltype(auto) {
+        return [&f]<size_t... Js>(std::index_sequence<Js...>) -> decltype(auto) {
+            return std::forward<F>(f)(
+                std::integral_constant<size_t, unflatten<K, Ns...>()[Js]>()...);
+        }(std::make_index_sequence<sizeof...(Ns)>());
+    };
+    return dispatch<(Ns * ... * 1)>(flat, split);
+}
+
+}  // namespace variant_detail
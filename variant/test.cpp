@@ -1,11 +1,13 @@
 #include <cassert>
 #include <catch2/catch_test_macros.hpp>
+#include <cstring>
 #include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "variant.h"
+#include "variant_vector.h"
 
 // template <typename... Args>
 // using Variant = std::variant<Args...>;
@@ -350,4 +352,257 @@ TEST_CASE("MultipleVisit") {
 }
 
 static_assert(
-    !std::is_base_of_v<std::variant<VerySpecialType, int>, Variant<VerySpecialType, int>>);
\ No newline at end of file
+    !std::is_base_of_v<std::variant<VerySpecialType, int>, Variant<VerySpecialType, int>>);
+
+template <size_t I>
+struct Tag {
+    size_t value = I;
+};
+
+template <size_t... Is>
+auto MakeTagVariant(std::index_sequence<Is...>) -> Variant<Tag<Is>...>;
+
+using ManyTags = decltype(MakeTagVariant(std::make_index_sequence<64>()));
+
+struct ThrowsOnCopy {
+    ThrowsOnCopy() = default;
+    ThrowsOnCopy(const ThrowsOnCopy&) {
+        throw 1;
+    }
+    ThrowsOnCopy& operator=(const ThrowsOnCopy&) = default;
+};
+
+TEST_CASE("ManyAlternatives") {
+    // as many alternatives as the dispatch switch has cases
+    ManyTags v;
+    auto value = [](const auto& tag) { return tag.value; };
+    REQUIRE(visit(value, v) == 0);
+    v = Tag<37>();
+    REQUIRE(visit(value, v) == 37);
+    v.emplace<63>();
+    REQUIRE(v.index() == 63);
+    REQUIRE(visit(value, v) == 63);
+
+    Variant<int, ThrowsOnCopy> broken = 5;
+    ThrowsOnCopy source;
+    REQUIRE_THROWS(broken = source);
+    REQUIRE(broken.valueless_by_exception());
+    REQUIRE_THROWS_AS(visit([](const auto&) {}, broken), std::bad_variant_access);
+    broken = 7;
+    REQUIRE(get<int>(broken) == 7);
+}
+
+TEST_CASE("VisitSeveral") {
+    // one flattened 3 x 5 x 64 x 2 table, too big for the switch
+    decltype(MakeTagVariant(std::make_index_sequence<3>())) first;
+    decltype(MakeTagVariant(std::make_index_sequence<5>())) second;
+    ManyTags third;
+    Variant<int, std::string> fourth = "four";
+    auto digits = Overload{
+        [](const auto& a, const auto& b, const auto& c, int) {
+            return a.value * 10000 + b.value * 1000 + c.value;
+        },
+        [](const auto& a, const auto& b, const auto& c, const std::string& s) {
+            return a.value * 10000 + b.value * 1000 + c.value + s.size() * 100000;
+        },
+    };
+    REQUIRE(visit(digits, first, second, third, fourth) == 400000);
+
+    first.emplace<2>();
+    second.emplace<4>();
+    third.emplace<57>();
+    REQUIRE(visit(digits, first, second, third, fourth) == 424057);
+
+    fourth = 1;
+    second.emplace<1>();
+    third.emplace<63>();
+    REQUIRE(visit(digits, first, second, third, fourth) == 21063);
+    REQUIRE(visit(digits, std::as_const(first), second, std::move(third), fourth) == 21063);
+}
+
+// not a C-like struct, so the ABI lets others use its three bytes of tail padding
+struct SmallStruct {
+    SmallStruct(int x, char c, bool fail = false) : x(x), c(c) {
+        if (fail) {
+            throw 1;
+        }
+    }
+
+    int x;
+    char c;
+};
+
+struct PlainStruct {
+    int x;
+    char c;
+};
+
+// has tail padding too, but copies itself with a memcpy of sizeof(*this)
+struct CopiedWhole {
+    CopiedWhole(int x, char c) : x(x), c(c) {
+    }
+
+    CopiedWhole(const CopiedWhole& other) {
+        std::memcpy(static_cast<void*>(this), &other, sizeof(*this));
+    }
+
+    CopiedWhole& operator=(const CopiedWhole& other) {
+        std::memcpy(static_cast<void*>(this), &other, sizeof(*this));
+        return *this;
+    }
+
+    int x;
+    char c;
+};
+
+TEST_CASE("Layout") {
+    static_assert(sizeof(Variant<char, bool>) == 2);
+    static_assert(sizeof(Variant<int, float>) == 8);
+    static_assert(sizeof(Variant<double, char>) == 16);
+    static_assert(sizeof(ManyTags) == 2 * sizeof(size_t));
+    // the index sits in the padding of SmallStruct
+    static_assert(sizeof(Variant<int, float, SmallStruct>) == sizeof(SmallStruct));
+    static_assert(sizeof(Variant<int, float, PlainStruct>) == sizeof(PlainStruct) + 4);
+
+    Variant<int, float, SmallStruct> v = SmallStruct(1, 'a');
+    REQUIRE(v.index() == 2);
+    get<SmallStruct>(v) = SmallStruct(2, 'b');
+    v = SmallStruct(3, 'c');
+    REQUIRE(v.index() == 2);
+    REQUIRE(get<SmallStruct>(v).x == 3);
+    REQUIRE(get<SmallStruct>(v).c == 'c');
+    v = 1.5f;
+    REQUIRE(get<float>(v) == 1.5f);
+
+    REQUIRE_THROWS(v.emplace<SmallStruct>(4, 'd', true));
+    REQUIRE(v.valueless_by_exception());
+    Variant<int, float, SmallStruct> copy = v;
+    REQUIRE(copy.valueless_by_exception());
+    v.emplace<SmallStruct>(5, 'e');
+    copy = std::move(v);
+    REQUIRE(get<SmallStruct>(copy).x == 5);
+
+    // the index stays out of the tail of an alternative that isn't trivially copyable
+    static_assert(sizeof(Variant<int, CopiedWhole>) == sizeof(CopiedWhole) + 4);
+    Variant<int, CopiedWhole> whole = CopiedWhole(1, 'a');
+    CopiedWhole garbage(2, 'b');
+    std::memset(static_cast<void*>(&garbage), 0xff, sizeof(garbage));
+    garbage.x = 2;
+    get<CopiedWhole>(whole) = garbage;
+    REQUIRE(whole.index() == 1);
+    REQUIRE(get<1>(whole).x == 2);
+}
+
+TEST_CASE("TriviallyCopyable") {
+    using Trivial = Variant<int, float, SmallStruct>;
+    static_assert(std::is_trivially_copyable_v<Trivial>);
+    static_assert(std::is_trivially_destructible_v<Trivial>);
+    static_assert(std::is_trivially_copy_constructible_v<Trivial>);
+    static_assert(std::is_trivially_move_assignable_v<Trivial>);
+    static_assert(!std::is_trivially_copyable_v<Variant<int, std::string>>);
+    static_assert(!std::is_trivially_copy_constructible_v<Variant<int, ThrowsOnCopy>>);
+    static_assert(std::is_trivially_destructible_v<Variant<int, ThrowsOnCopy>>);
+    static_assert(std::is_copy_constructible_v<Variant<int, std::string>>);
+    static_assert(!std::is_copy_constructible_v<Variant<int, OneShot>>);
+
+    std::vector<Trivial> from = {1, 2.5f, SmallStruct(3, 'c')};
+    REQUIRE_THROWS(from[0].emplace<SmallStruct>(0, 'x', true));
+    std::vector<Trivial> to(from.size(), 0);
+    std::memcpy(to.data(), from.data(), from.size() * sizeof(Trivial));
+    REQUIRE(to[0].valueless_by_exception());
+    REQUIRE(get<float>(to[1]) == 2.5f);
+    REQUIRE(get<SmallStruct>(to[2]).c == 'c');
+
+    Trivial copy = to[2];
+    copy = to[1];
+    REQUIRE(get<float>(copy) == 2.5f);
+}
+
+TEST_CASE("VariantVector") {
+    VariantVector<int, double, std::string> events;
+    REQUIRE(events.empty());
+    events.push_back(1);
+    events.push_back(std::string("two"));
+    events.push_back(3.5);
+    events.emplace_back<int>(4);
+    events.emplace_back<2>(2, 'x');
+    events.push_back(Variant<int, double, std::string>(6.5));
+    REQUIRE(events.size() == 6);
+    REQUIRE(events.index(1) == 2);
+
+    REQUIRE(events.column<int>().size() == 2);
+    REQUIRE(events.column<1>()[1] == 6.5);
+    for (int& value : events.column<int>()) {
+        value *= 10;
+    }
+    REQUIRE(get<int>(events[3]) == 40);
+    REQUIRE(get<std::string>(events[4]) == "xx");
+
+    // one type after another
+    std::string grouped;
+    events.visit_all(Overload{
+        [&](int value) { grouped += std::to_string(value) + ' '; },
+        [&](double value) { grouped += std::to_string(static_cast<int>(value * 2)) + ' '; },
+        [&](std::string& value) {
+            value += '!';
+            grouped += value + ' ';
+        },
+    });
+    REQUIRE(grouped == "10 40 7 13 two! xx! ");
+
+    // the order of insertion
+    std::string ordered;
+    std::as_const(events).for_each([&](const auto& value) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>) {
+            ordered += value;
+        } else {
+            ordered += std::to_string(static_cast<int>(value));
+        }
+    });
+    REQUIRE(ordered == "10two!340xx!6");
+    REQUIRE(events.visit_at([](const auto& value) { return sizeof(value); }, 2) == sizeof(double));
+
+    events.clear();
+    REQUIRE(events.empty());
+    REQUIRE(events.column<std::string>().empty());
+}
+
+struct FailingCopy {
+    FailingCopy() = default;
+    FailingCopy(const FailingCopy&) {
+        throw 1;
+    }
+    FailingCopy(FailingCopy&&) noexcept = default;
+    FailingCopy& operator=(const FailingCopy&) = default;
+    FailingCopy& operator=(FailingCopy&&) noexcept = default;
+};
+
+using Strict = Variant<int, SmallStruct, FailingCopy, std::string>;
+
+template <>
+inline constexpr bool enable_never_valueless<Strict> = true;
+
+TEST_CASE("NeverValueless") {
+    Strict v = 5;
+    REQUIRE_THROWS(v.emplace<SmallStruct>(1, 'a', true));
+    REQUIRE(get<int>(v) == 5);
+
+    FailingCopy source;
+    REQUIRE_THROWS(v = source);
+    REQUIRE(get<int>(v) == 5);
+    v = std::move(source);
+    REQUIRE(v.index() == 2);
+
+    v = "string";
+    Strict other = SmallStruct(2, 'b');
+    other = v;
+    REQUIRE(get<std::string>(other) == "string");
+    REQUIRE_THROWS(other.emplace<SmallStruct>(3, 'c', true));
+    REQUIRE(!other.valueless_by_exception());
+    REQUIRE(visit([](const auto& value) { return sizeof(value); }, other) == sizeof(std::string));
+
+    // nothing changes for the others
+    Variant<int, SmallStruct> plain = 5;
+    REQUIRE_THROWS(plain.emplace<SmallStruct>(1, 'a', true));
+    REQUIRE(plain.valueless_by_exception());
+}
@@ -1,5 +1,502 @@
-template <typename...>
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>  // std::bad_variant_access
+
+#include "detail/dispatch.h"
+
+template <typename... Types>
+class Variant;
+
+// Opt-in for a particular Variant: specialize as true before the type is used,
+//
+//   template <>
+//   inline constexpr bool enable_never_valueless<Variant<int, std::string>> = true;
+//
+// and it never becomes valueless. Every alternative must have a nothrow move
+// constructor: a new value that may throw is built aside first and moved in
+// only once the old one is destroyed. index() and visit have no valueless
+// check then.
+template <typename V>
+inline constexpr bool enable_never_valueless = false;
+
+namespace variant_detail {
+
+inline constexpr size_t kNpos = static_cast<size_t>(-1);
+
+template <size_t I, typename... Types>
+using type_at = std::tuple_element_t<I, std::tuple<Types...>>;
+
+template <typename T, typename... Types>
+inline constexpr size_t kCount = (static_cast<size_t>(std::is_same_v<T, Types>) + ... + 0);
+
+template <typename T, typename... Types>
+constexpr size_t index_of() {
+    constexpr bool kMatches[] = {std::is_same_v<T, Types>...};
+    for (size_t i = 0; i < sizeof...(Types); ++i) {
+        if (kMatches[i]) {
+            return i;
+        }
+    }
+    return kNpos;
+}
+
+// T_i x[] = {std::forward<T>(t)} has to compile, which rules out narrowing
+template <typename Ti, typename T>
+concept non_narrowing = requires(T&& t) { std::type_identity_t<Ti[]>{std::forward<T>(t)}; };
+
+// one imaginary F(T_i) per alternative, as in the std::variant converting
+// constructor; overload resolution among them picks the alternative
+template <size_t I, typename Ti>
+struct candidate {
+    template <typename T>
+        requires non_narrowing<Ti, T>
+    std::integral_constant<size_t, I> operator()(Ti, T&&) const;
+};
+
+template <typename Indices, typename... Types>
+struct candidates;
+
+template <size_t... Is, typename... Types>
+struct candidates<std::index_sequence<Is...>, Types...> : candidate<Is, Types>... {
+    using candidate<Is, Types>::operator()...;
+};
+
+template <typename T, typename... Types>
+using selected = decltype(candidates<std::index_sequence_for<Types...>, Types...>()(
+    std::declval<T>(), std::declval<T>()));
+
+template <typename T, typename... Types>
+concept selectable = requires { typename selected<T, Types...>; };
+
+// smallest unsigned type for every index and the valueless marker, its maximum
+template <size_t N>
+using index_type = std::conditional_t<(N < UINT8_MAX), uint8_t,
+                                      std::conditional_t<(N < UINT16_MAX), uint16_t, uint32_t>>;
+
+// T and then N more bytes; the ABI puts them into the tail padding of T
+// wherever the next member may go there (classes that are not C-like structs)
+template <typename T, size_t N>
+struct tail_probe {
+    [[no_unique_address]] T value;
+    unsigned char tail[N];
+};
+
+// bytes at the end of T that it never writes once it is constructed. Only
+// trivially copyable T are trusted with this: their copies are made by the
+// compiler, which knows not to touch the tail, while a user-written copy or
+// assignment may well memcpy all of sizeof(T) over the index
+template <typename T>
+constexpr size_t reusable_tail() {
+    if constexpr (std::is_class_v<T> && std::is_trivially_copyable_v<T>) {
+        return []<size_t... Ns>(std::index_sequence<Ns...>) {
+            size_t result = 0;
+            ((result = sizeof(tail_probe<T, Ns + 1>) == sizeof(T) ? Ns + 1 : result), ...);
+            return result;
+        }(std::make_index_sequence<alignof(T) - 1>());
+    } else {
+        return 0;
+    }
+}
+
+// where the index goes: right after the data of the longest alternative, so
+// that it lands in the tail padding of every alternative that lends some
+template <typename Index, typename... Types>
+inline constexpr size_t kIndexAt =
+    (std::max({sizeof(Types) - reusable_tail<Types>()...}) + alignof(Index) - 1) /
+    alignof(Index) * alignof(Index);
+
+// concepts over the whole pack, so that the trivial special members of
+// Variant subsume the general ones
+template <typename... Types>
+concept all_copy_constructible = (std::is_copy_constructible_v<Types> && ...);
+
+template <typename... Types>
+concept all_move_constructible = (std::is_move_constructible_v<Types> && ...);
+
+template <typename... Types>
+concept all_trivially_destructible = (std::is_trivially_destructible_v<Types> && ...);
+
+template <typename... Types>
+concept all_trivially_copy_constructible = (std::is_trivially_copy_constructible_v<Types> && ...);
+
+template <typename... Types>
+concept all_trivially_move_constructible = (std::is_trivially_move_constructible_v<Types> && ...);
+
+template <typename... Types>
+concept all_trivially_copy_assignable =
+    all_trivially_copy_constructible<Types...> && all_trivially_destructible<Types...> &&
+    (std::is_trivially_copy_assignable_v<Types> && ...);
+
+template <typename... Types>
+concept all_trivially_move_assignable =
+    all_trivially_move_constructible<Types...> && all_trivially_destructible<Types...> &&
+    (std::is_trivially_move_assignable_v<Types> && ...);
+
+template <typename V>
+struct size_of;
+
+template <typename... Types>
+struct size_of<Variant<Types...>> : std::integral_constant<size_t, sizeof...(Types)> {};
+
+template <typename V>
+inline constexpr size_t kSize = size_of<std::remove_cvref_t<V>>::value;
+
+// the only way into the storage from outside the class
+struct access {
+    template <size_t I, typename V>
+    static decltype(auto) get(V&& variant) {
+        return std::forward<V>(variant).template alternative<I>();
+    }
+};
+
+}  // namespace variant_detail
+
+template <typename... Types>
 class Variant {
+    static_assert(sizeof...(Types) > 0, "Variant needs at least one alternative");
+
+    template <size_t I>
+    using type_at = variant_detail::type_at<I, Types...>;
+
+    friend struct variant_detail::access;
+
+    static constexpr bool kNeverValueless = enable_never_valueless<Variant>;
+    static_assert(!kNeverValueless || (std::is_nothrow_move_constructible_v<Types> && ...),
+                  "a never valueless Variant needs nothrow move constructible alternatives");
+
+    using index_type = variant_detail::index_type<sizeof...(Types)>;
+
+    static constexpr size_t kIndexAt = variant_detail::kIndexAt<index_type, Types...>;
+
+    // the alternative from the start, the index at kIndexAt: inside the
+    // storage when the alternatives leave room for it, past them otherwise
+    alignas(Types...) alignas(index_type)
+        unsigned char storage_[std::max({kIndexAt + sizeof(index_type), sizeof(Types)...})];
+
+    // kNpos is stored as the maximum of index_type
+    void set_index(size_t index) {
+        index_type stored = static_cast<index_type>(index);
+        std::memcpy(storage_ + kIndexAt, &stored, sizeof(stored));
+    }
+
+    template <size_t I>
+    type_at<I>& alternative() & {
+        return *std::launder(reinterpret_cast<type_at<I>*>(storage_));
+    }
+
+    template <size_t I>
+    const type_at<I>& alternative() const& {
+        return *std::launder(reinterpret_cast<const type_at<I>*>(storage_));
+    }
+
+    template <size_t I>
+    type_at<I>&& alternative() && {
+        return std::move(alternative<I>());
+    }
+
+    template <size_t I>
+    const type_at<I>&& alternative() const&& {
+        return std::move(alternative<I>());
+    }
+
+    // calls f(std::integral_constant<size_t, index()>())
+    template <typename F>
+    decltype(auto) with_index(F&& f) const {
+        return variant_detail::dispatch<sizeof...(Types)>(index(), std::forward<F>(f));
+    }
+
+    // the variant must be valueless. The index is written after the value:
+    // constructing may zero the whole object, tail padding included
+    template <size_t I, typename... Args>
+    type_at<I>& construct(Args&&... args) {
+        try {
+            ::new (static_cast<void*>(storage_)) type_at<I>(std::forward<Args>(args)...);
+        } catch (...) {
+            set_index(variant_detail::kNpos);
+            throw;
+        }
+        set_index(I);
+        return alternative<I>();
+    }
+
+    void destroy() {
+        if (!valueless_by_exception()) {
+            with_index([this]<size_t I>(std::integral_constant<size_t, I>) {
+                std::destroy_at(&alternative<I>());
+            });
+            set_index(variant_detail::kNpos);
+        }
+    }
+
+    // the old value is destroyed first; an exception from the new one leaves
+    // the variant valueless, unless it is never valueless
+    template <size_t I, typename... Args>
+    type_at<I>& replace(Args&&... args) {
+        if constexpr (kNeverValueless && !std::is_nothrow_constructible_v<type_at<I>, Args...>) {
+            type_at<I> value(std::forward<Args>(args)...);
+            destroy();
+            return construct<I>(std::move(value));
+        } else {
+            destroy();
+            return construct<I>(std::forward<Args>(args)...);
+        }
+    }
+
+    // same alternative: assigned in place; another one: replaced
+    template <size_t I, typename T>
+    void assign(T&& value) {
+        if constexpr (std::is_assignable_v<type_at<I>&, T&&>) {
+            if (index() == I) {
+                alternative<I>() = std::forward<T>(value);
+                return;
+            }
+        }
+        emplace<I>(std::forward<T>(value));
+    }
+
+public:
+    Variant()
+        requires std::is_default_constructible_v<type_at<0>>
+    {
+        construct<0>();
+    }
+
+    // with trivial alternatives copying the bytes of the storage copies the
+    // value and the index, and Variant is trivially copyable itself
+    Variant(const Variant&)
+        requires variant_detail::all_copy_constructible<Types...> &&
+                 variant_detail::all_trivially_copy_constructible<Types...>
+    = default;
+
+    Variant(const Variant& other)
+        requires variant_detail::all_copy_constructible<Types...>
+    {
+        set_index(variant_detail::kNpos);
+        if (!other.valueless_by_exception()) {
+            other.with_index([&]<size_t I>(std::integral_constant<size_t, I>) {
+                construct<I>(other.alternative<I>());
+            });
+        }
+    }
+
+    Variant(Variant&&)
+        requires variant_detail::all_move_constructible<Types...> &&
+                 variant_detail::all_trivially_move_constructible<Types...>
+    = default;
+
+    Variant(Variant&& other) noexcept((std::is_nothrow_move_constructible_v<Types> && ...))
+        requires variant_detail::all_move_constructible<Types...>
+    {
+        set_index(variant_detail::kNpos);
+        if (!other.valueless_by_exception()) {
+            other.with_index([&]<size_t I>(std::integral_constant<size_t, I>) {
+                construct<I>(std::move(other).template alternative<I>());
+            });
+        }
+    }
+
+    template <typename T>
+        requires(!std::is_same_v<std::remove_cvref_t<T>, Variant>) &&
+                variant_detail::selectable<T, Types...>
+    Variant(T&& value) {
+        construct<variant_detail::selected<T, Types...>::value>(std::forward<T>(value));
+    }
+
+    Variant& operator=(const Variant&)
+        requires variant_detail::all_copy_constructible<Types...> &&
+                 variant_detail::all_trivially_copy_assignable<Types...>
+    = default;
+
+    Variant& operator=(const Variant& other)
+        requires variant_detail::all_copy_constructible<Types...>
+    {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.valueless_by_exception()) {
+            destroy();
+            return *this;
+        }
+        other.with_index([&]<size_t I>(std::integral_constant<size_t, I>) {
+            assign<I>(other.alternative<I>());
+        });
+        return *this;
+    }
+
+    Variant& operator=(Variant&&)
+        requires variant_detail::all_move_constructible<Types...> &&
+                 variant_detail::all_trivially_move_assignable<Types...>
+    = default;
+
+    Variant& operator=(Variant&& other) noexcept((std::is_nothrow_move_constructible_v<Types> &&
+                                                  ...))
+        requires variant_detail::all_move_constructible<Types...>
+    {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.valueless_by_exception()) {
+            destroy();
+            return *this;
+        }
+        other.with_index([&]<size_t I>(std::integral_constant<size_t, I>) {
+            assign<I>(std::move(other).template alternative<I>());
+        });
+        return *this;
+    }
+
+    template <typename T>
+        requires(!std::is_same_v<std::remove_cvref_t<T>, Variant>) &&
+                variant_detail::selectable<T, Types...>
+    Variant& operator=(T&& value) {
+        assign<variant_detail::selected<T, Types...>::value>(std::forward<T>(value));
+        return *this;
+    }
+
+    ~Variant()
+        requires variant_detail::all_trivially_destructible<Types...>
+    = default;
+
+    ~Variant() {
+        destroy();
+    }
+
+    template <typename T, typename... Args>
+        requires(variant_detail::kCount<T, Types...> == 1) && std::is_constructible_v<T, Args...>
+    T& emplace(Args&&... args) {
+        return emplace<variant_detail::index_of<T, Types...>()>(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename U, typename... Args>
+        requires(variant_detail::kCount<T, Types...> == 1) &&
+                std::is_constructible_v<T, std::initializer_list<U>&, Args...>
+    T& emplace(std::initializer_list<U> list, Args&&... args) {
+        return emplace<variant_detail::index_of<T, Types...>()>(list, std::forward<Args>(args)...);
+    }
+
+    template <size_t I, typename... Args>
+        requires(I < sizeof...(Types)) && std::is_constructible_v<type_at<I>, Args...>
+    type_at<I>& emplace(Args&&... args) {
+        return replace<I>(std::forward<Args>(args)...);
+    }
+
+    template <size_t I, typename U, typename... Args>
+        requires(I < sizeof...(Types)) &&
+                std::is_constructible_v<type_at<I>, std::initializer_list<U>&, Args...>
+    type_at<I>& emplace(std::initializer_list<U> list, Args&&... args) {
+        return replace<I>(list, std::forward<Args>(args)...);
+    }
+
+    size_t index() const {
+        index_type stored;
+        std::memcpy(&stored, storage_ + kIndexAt, sizeof(stored));
+        if constexpr (kNeverValueless) {
+            return stored;
+        } else {
+            return stored == static_cast<index_type>(variant_detail::kNpos) ? variant_detail::kNpos
+                                                                             : stored;
+        }
+    }
+
+    bool valueless_by_exception() const {
+        if constexpr (kNeverValueless) {
+            return false;
+        } else {
+            return index() == variant_detail::kNpos;
+        }
+    }
+};
+
+template <typename T, typename... Types>
+    requires(variant_detail::kCount<T, Types...> == 1)
+bool holds_alternative(const Variant<Types...>& variant) {
+    return variant.index() == variant_detail::index_of<T, Types...>();
+}
+
+namespace variant_detail {
+
+template <size_t I, typename V>
+decltype(auto) checked_get(V&& variant) {
+    if (variant.index() != I) {
+        throw std::bad_variant_access();
+    }
+    return access::get<I>(std::forward<V>(variant));
+}
+
+}  // namespace variant_detail
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+variant_detail::type_at<I, Types...>& get(Variant<Types...>& variant) {
+    return variant_detail::checked_get<I>(variant);
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+const variant_detail::type_at<I, Types...>& get(const Variant<Types...>& variant) {
+    return variant_detail::checked_get<I>(variant);
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+variant_detail::type_at<I, Types...>&& get(Variant<Types...>&& variant) {
+    return variant_detail::checked_get<I>(std::move(variant));
+}
+
+template <size_t I, typename... Types>
+    requires(I < sizeof...(Types))
+const variant_detail::type_at<I, Types...>&& get(const Variant<Types...>&& variant) {
+    return variant_detail::checked_get<I>(std::move(variant));
+}
+
+template <typename T, typename... Types>
+    requires(variant_detail::kCount<T, Types...> == 1)
+T& get(Variant<Types...>& variant) {
+    return get<variant_detail::index_of<T, Types...>()>(variant);
+}
+
+template <typename T, typename... Types>
+    requires(variant_detail::kCount<T, Types...> == 1)
+const T& get(const Variant<Types...>& variant) {
+    return get<variant_detail::index_of<T, Types...>()>(variant);
+}
+
+template <typename T, typename... Types>
+    requires(variant_detail::kCount<T, Types...> == 1)
+T&& get(Variant<Types...>&& variant) {
+    return get<variant_detail::index_of<T, Types...>()>(std::move(variant));
+}
+
+template <typename T, typename... Types>
+    requires(variant_detail::kCount<T, Types...> == 1)
+const T&& get(const Variant<Types...>&& variant) {
+    return get<variant_detail::index_of<T, Types...>()>(std::move(variant));
+}
 
-    // YOUR CODE HERE
-};
\ No newline at end of file
+// The visitor has to return the same type for every combination of
+// alternatives; the one for the first alternatives is taken. Any number of
+// variants costs one dispatch, see dispatch_all.
+template <typename Visitor, typename... Variants>
+decltype(auto) visit(Visitor&& visitor, Variants&&... variants) {
+    using R = std::invoke_result_t<Visitor, decltype(variant_detail::access::get<0>(
+                                                std::declval<Variants>()))...>;
+    if ((variants.valueless_by_exception() || ...)) {
+        throw std::bad_variant_access();
+    }
+    return variant_detail::dispatch_all<variant_detail::kSize<Variants>...>(
+        {variants.index()...}, [&]<size_t... Is>(std::integral_constant<size_t, Is>...) -> R {
+            return std::invoke(std::forward<Visitor>(visitor),
+                               variant_detail::access::get<Is>(std::forward<Variants>(variants))...);
+        });
+}
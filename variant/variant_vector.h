@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "variant.h"
+
+// A sequence of Variant<Types...> stored as a structure of arrays: the values
+// of each alternative in their own contiguous vector, plus a stream of
+// indices that remembers which alternative every element has and where in
+// its vector it went.
+//
+// visit_all walks one vector at a time, so the visitor is called on a single
+// type in a tight loop, with no dispatch, and the compiler can vectorize it.
+// Elements come type by type then, in the order of insertion within a type;
+// for_each keeps the order of the whole sequence.
+template <typename... Types>
+class VariantVector {
+    template <size_t I>
+    using type_at = variant_detail::type_at<I, Types...>;
+
+    using index_type = variant_detail::index_type<sizeof...(Types)>;
+
+    std::tuple<std::vector<Types>...> columns_;
+    std::vector<index_type> indices_;
+    std::vector<size_t> positions_;
+
+    template <typename F, size_t... Is>
+    void visit_columns(F& f, std::index_sequence<Is...>) {
+        (f(std::get<Is>(columns_)), ...);
+    }
+
+    template <typename F, size_t... Is>
+    void visit_columns(F& f, std::index_sequence<Is...>) const {
+        (f(std::get<Is>(columns_)), ...);
+    }
+
+public:
+    using value_type = Variant<Types...>;
+
+    VariantVector() = default;
+
+    template <size_t I, typename... Args>
+        requires(I < sizeof...(Types)) && std::is_constructible_v<type_at<I>, Args...>
+    type_at<I>& emplace_back(Args&&... args) {
+        auto& column = std::get<I>(columns_);
+        indices_.reserve(indices_.size() + 1);
+        positions_.reserve(positions_.size() + 1);
+        column.emplace_back(std::forward<Args>(args)...);
+        indices_.push_back(static_cast<index_type>(I));
+        positions_.push_back(column.size() - 1);
+        return column.back();
+    }
+
+    template <typename T, typename... Args>
+        requires(variant_detail::kCount<T, Types...> == 1) && std::is_constructible_v<T, Args...>
+    T& emplace_back(Args&&... args) {
+        return emplace_back<variant_detail::index_of<T, Types...>()>(std::forward<Args>(args)...);
+    }
+
+    // the alternative is chosen as by the converting constructor of Variant
+    template <typename T>
+        requires(!std::is_same_v<std::remove_cvref_t<T>, value_type>) &&
+                variant_detail::selectable<T, Types...>
+    void push_back(T&& value) {
+        emplace_back<variant_detail::selected<T, Types...>::value>(std::forward<T>(value));
+    }
+
+    void push_back(const value_type& variant) {
+        if (variant.valueless_by_exception()) {
+            throw std::bad_variant_access();
+        }
+        variant_detail::dispatch<sizeof...(Types)>(
+            variant.index(), [&]<size_t I>(std::integral_constant<size_t, I>) {
+                emplace_back<I>(get<I>(variant));
+            });
+    }
+
+    size_t size() const {
+        return indices_.size();
+    }
+
+    bool empty() const {
+        return indices_.empty();
+    }
+
+    void reserve(size_t count) {
+        indices_.reserve(count);
+        positions_.reserve(count);
+    }
+
+    void clear() {
+        std::apply([](auto&... columns) { (columns.clear(), ...); }, columns_);
+        indices_.clear();
+        positions_.clear();
+    }
+
+    // alternative of the i-th element
+    size_t index(size_t i) const {
+        return indices_[i];
+    }
+
+    // all values of one alternative, in the order of insertion
+    template <size_t I>
+        requires(I < sizeof...(Types))
+    std::span<type_at<I>> column() {
+        return std::get<I>(columns_);
+    }
+
+    template <size_t I>
+        requires(I < sizeof...(Types))
+    std::span<const type_at<I>> column() const {
+        return std::get<I>(columns_);
+    }
+
+    template <typename T>
+        requires(variant_detail::kCount<T, Types...> == 1)
+    std::span<T> column() {
+        return column<variant_detail::index_of<T, Types...>()>();
+    }
+
+    template <typename T>
+        requires(variant_detail::kCount<T, Types...> == 1)
+    std::span<const T> column() const {
+        return column<variant_detail::index_of<T, Types...>()>();
+    }
+
+    // visitor(i-th element)
+    template <typename Visitor>
+    decltype(auto) visit_at(Visitor&& visitor, size_t i) {
+        return variant_detail::dispatch<sizeof...(Types)>(
+            indices_[i], [&]<size_t I>(std::integral_constant<size_t, I>) -> decltype(auto) {
+                return std::invoke(std::forward<Visitor>(visitor),
+                                   std::get<I>(columns_)[positions_[i]]);
+            });
+    }
+
+    template <typename Visitor>
+    decltype(auto) visit_at(Visitor&& visitor, size_t i) const {
+        return variant_detail::dispatch<sizeof...(Types)>(
+            indices_[i], [&]<size_t I>(std::integral_constant<size_t, I>) -> decltype(auto) {
+                return std::invoke(std::forward<Visitor>(visitor),
+                                   std::get<I>(columns_)[positions_[i]]);
+            });
+    }
+
+    value_type operator[](size_t i) const {
+        return visit_at([](const auto& value) -> value_type { return value; }, i);
+    }
+
+    // visitor(value) for every element, one alternative after another
+    template <typename Visitor>
+    void visit_all(Visitor&& visitor) {
+        auto loop = [&visitor](auto& column) {
+            for (auto& value : column) {
+                std::invoke(visitor, value);
+            }
+        };
+        visit_columns(loop, std::index_sequence_for<Types...>());
+    }
+
+    template <typename Visitor>
+    void visit_all(Visitor&& visitor) const {
+        auto loop = [&visitor](const auto& column) {
+            for (const auto& value : column) {
+                std::invoke(visitor, value);
+            }
+        };
+        visit_columns(loop, std::index_sequence_for<Types...>());
+    }
+
+    // visitor(value) for every element in the order of the sequence
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) {
+        for (size_t i = 0; i < size(); ++i) {
+            visit_at(visitor, i);
+        }
+    }
+
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) const {
+        for (size_t i = 0; i < size(); ++i) {
+            visit_at(visitor, i);
+        }
+    }
+};